@@ -27,6 +27,7 @@
 #define _guard_FORMATXX_DETAIL_APPEND_WRITER_H
 #pragma once
 
+#include "formatxx/allocation_tracking.h"
 #include <litexx/string_view.h>
 
 namespace formatxx {
@@ -42,7 +43,7 @@ public:
     constexpr append_writer(ContainerT& container) : _container(container) {}
 
     constexpr void write(litexx::basic_string_view<typename ContainerT::value_type> str) override {
-        _container.append(str.data(), str.size());
+        FORMATXX_TRACK_CAPACITY_CHANGE(_container, _container.append(str.data(), str.size()));
     }
 
 private:
@@ -74,6 +74,15 @@ public:
 
     FORMATXX_PUBLIC result_code FORMATXX_API format_into(basic_format_writer<CharT>& output, basic_format_options<CharT> const& options) const;
 
+    constexpr _detail::format_arg_type type() const noexcept { return _type; }
+
+    /// The same argument for a value that has been moved to another address.
+    constexpr basic_format_arg relocated(void const* value) const noexcept {
+        basic_format_arg result = *this;
+        result._value = value;
+        return result;
+    }
+
 private:
     _detail::format_arg_type _type = _detail::format_arg_type::unknown;
     thunk_type _thunk = nullptr;
@@ -90,11 +99,16 @@ public:
 
     constexpr basic_format_arg_list() noexcept = default;
     constexpr basic_format_arg_list(std::initializer_list<format_arg_type> args) noexcept : _args(args.begin()), _count(args.size()) {}
+    constexpr basic_format_arg_list(format_arg_type const* args, size_type count) noexcept : _args(args), _count(count) {}
 
     constexpr result_code format_arg(basic_format_writer<CharT>& output, size_type index, basic_format_options<CharT> const& options) const {
         return index < _count ? _args[index].format_into(output, options) : result_code::out_of_range;
     }
 
+    constexpr _detail::format_arg_type arg_type(size_type index) const noexcept {
+        return index < _count ? _args[index].type() : _detail::format_arg_type::unknown;
+    }
+
 private:
     basic_format_arg<CharT> const* _args = nullptr;
     size_type _count = 0;
@@ -107,6 +121,10 @@ namespace formatxx::_detail {
     template <typename T>
     using formattable_t = decay_array_t<std::remove_reference_t<T>>;
 
+    /// How an argument is held by objects that format after the call returns: scalars (including decayed arrays) by copy, everything else by reference.
+    template <typename T>
+    using stored_arg_t = std::conditional_t<std::is_scalar_v<T>, T, T const&>;
+
     template <typename C, typename T, typename V = void>
     struct has_format_value { static constexpr bool value = false; };
     template <typename C, typename T>
@@ -133,7 +151,7 @@ namespace formatxx::_detail {
     FORMATXX_TYPE(bool, boolean);
     FORMATXX_TYPE(char*, char_string);
     FORMATXX_TYPE(char const*, char_string);
-    FORMATXX_TYPE(wchar_t*, char_string);
+    FORMATXX_TYPE(wchar_t*, wchar_string);
     FORMATXX_TYPE(wchar_t const*, wchar_string);
     FORMATXX_TYPE(std::nullptr_t, null_pointer);
     FORMATXX_TYPE(void*, void_pointer);
@@ -35,108 +35,181 @@
 #include "parse_unsigned.h"
 #include "parse_format.h"
 
+namespace formatxx::_detail {
+	template <typename CharT> struct format_step;
+}
+
+/// One step through a format string: a run of literal text, optionally followed by a replacement field.
+template <typename CharT>
+struct formatxx::_detail::format_step {
+	basic_string_view<CharT> literal;
+	/// name given to the field with a named placeholder such as {user}, otherwise empty
+	basic_string_view<CharT> name;
+	basic_format_options<CharT> options;
+	unsigned index = 0;
+	bool field = false;
+	result_code result = result_code::success;
+};
+
 namespace formatxx::_detail {
 
 	template <typename CharT>
-	FORMATXX_PUBLIC result_code FORMATXX_API format_impl(basic_format_writer<CharT>& out, basic_string_view<CharT> format, basic_format_arg_list<CharT> args) {
-		unsigned next_index = 0;
-		result_code result = result_code::success;
+	constexpr bool is_name_char(CharT ch, bool first) noexcept {
+		return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_' || (!first && ((ch >= '0' && ch <= '9') || ch == '.'));
+	}
 
-		CharT const* begin = format.data();
-		CharT const* const end = begin + format.size();
-		CharT const* iter = begin;
+	/// Parse the next step of a format string.
+	/// @param next_index The index used by the next automatically numbered field; updated when a field is parsed.
+	/// @returns the position following the step.
+	template <typename CharT>
+	CharT const* parse_format_step(CharT const* iter, CharT const* const end, unsigned& next_index, format_step<CharT>& step) {
+		CharT const* const begin = iter;
 
-		while (iter < end) {
-			if (*iter != FormatTraits<CharT>::cFormatBegin) {
-				++iter;
-				continue;
-			}
-			// write out the string so far, since we don't write characters immediately
-			if (iter > begin) {
-				out.write({ begin, iter });
-			}
+		step = {};
 
-			++iter; // swallow the {
+		while (iter < end && *iter != FormatTraits<CharT>::cFormatBegin) {
+			++iter;
+		}
 
-			// if we hit the end of the input, we have an incomplete format, and nothing else we can do
-			if (iter == end) {
-				result = result_code::malformed_input;
-				break;
-			}
+		step.literal = { begin, iter };
+		if (iter == end) {
+			return end;
+		}
 
-			// if we just have another { then take it as a literal character by starting our next begin here,
-			// so it'll get written next time we write out the begin; nothing else to do for formatting here
-			if (*iter == FormatTraits<CharT>::cFormatBegin) {
-				begin = iter++;
-				continue;
-			}
+		CharT const* const brace = iter++; // swallow the {
 
-			// determine which argument we're going to format
-			unsigned index = 0;
-			CharT const* const start = iter;
-			iter = parse_unsigned(start, end, index);
+		// if we hit the end of the input, we have an incomplete format, and nothing else we can do but write it as text
+		if (iter == end) {
+			step.literal = { begin, end };
+			step.result = result_code::malformed_input;
+			return end;
+		}
 
-			// if we hit the end of the string, we have an incomplete format
-			if (iter == end) {
-				result = result_code::malformed_input;
-				break;
-			}
+		// if we just have another { then take it as a literal character
+		if (*iter == FormatTraits<CharT>::cFormatBegin) {
+			step.literal = { begin, iter };
+			return iter + 1;
+		}
 
-			// if we read nothing, we have a "next index" situation (or an error)
-			if (iter == start) {
-				index = next_index;
-			}
+		// determine which argument we're going to format
+		unsigned index = 0;
+		CharT const* const start = iter;
+		iter = parse_unsigned(start, end, index);
 
-			basic_format_options<CharT> options;
+		// if we hit the end of the string, we have an incomplete format
+		if (iter == end) {
+			step.literal = { begin, end };
+			step.result = result_code::malformed_input;
+			return end;
+		}
 
-			// if a : follows the number, we have some formatting controls
-			if (*iter == FormatTraits<CharT>::cFormatSep) {
-				++iter; // eat separator
-				CharT const* const spec_begin = iter;
+		// if we read nothing, we have a "next index" situation, possibly named (or an error)
+		if (iter == start) {
+			index = next_index;
 
-				while (iter < end && *iter != FormatTraits<CharT>::cFormatEnd) {
+			if (is_name_char(*iter, true)) {
+				while (iter < end && is_name_char(*iter, false)) {
 					++iter;
 				}
+				step.name = { start, iter };
 
 				if (iter == end) {
-					// invalid options
-					result = result_code::malformed_input;
-					break;
+					step.literal = { begin, end };
+					step.result = result_code::malformed_input;
+					return end;
 				}
+			}
+		}
 
-                basic_parse_spec_result<CharT> const spec_result = parse_format_spec<CharT>({ spec_begin, iter });
-                if (spec_result.code != result_code::success) {
-                    result = spec_result.code;
-                    break;
-                }
+		// if a : follows the number, we have some formatting controls
+		if (*iter == FormatTraits<CharT>::cFormatSep) {
+			++iter; // eat separator
+			CharT const* const spec_begin = iter;
+
+			while (iter < end && *iter != FormatTraits<CharT>::cFormatEnd) {
+				++iter;
+			}
 
-                options = spec_result.options;
-                options.user = spec_result.unparsed;
+			if (iter == end) {
+				// invalid options
+				step.literal = { begin, end };
+				step.result = result_code::malformed_input;
+				return end;
 			}
 
-			// after the index/options, we expect an end to the format marker
-			if (*iter != FormatTraits<CharT>::cFormatEnd) {
-				// we have something besides a number, no bueno
-				result = result_code::malformed_input;
-				begin = iter; // make sure we're set up for the next begin, which starts at this unknown character
-				continue;
+			basic_parse_spec_result<CharT> const spec_result = parse_format_spec<CharT>({ spec_begin, iter });
+			if (spec_result.code != result_code::success) {
+				step.literal = { begin, end };
+				step.result = spec_result.code;
+				return end;
 			}
 
-			result_code const arg_result = args.format_arg(out, index, options);
+			step.options = spec_result.options;
+			step.options.user = spec_result.unparsed;
+		}
+
+		// after the index/options, we expect an end to the format marker
+		if (*iter != FormatTraits<CharT>::cFormatEnd) {
+			// we have something besides a number, no bueno; the text resumes at this unknown character
+			step.literal = { begin, brace };
+			step.result = result_code::malformed_input;
+			return iter;
+		}
+
+		step.field = true;
+		step.index = index;
+
+		// if we continue to receive {} then the next index will be the next one after the last one used
+		next_index = index + 1;
+
+		// the next step begins with the character following the format directive's end
+		return iter + 1;
+	}
+
+	/// Write the literal text and the formatted field of a parsed step.
+	/// @param field_out Receives the field's text, where out receives the literal.
+	/// @returns the error reported while parsing or formatting the step, if any.
+	template <typename CharT>
+	result_code write_format_step(basic_format_writer<CharT>& out, format_step<CharT> const& step, basic_format_arg_list<CharT> const& args, basic_format_writer<CharT>& field_out) {
+		if (!step.literal.empty()) {
+			out.write(step.literal);
+		}
+
+		result_code result = step.result;
+		if (step.field) {
+			result_code const arg_result = args.format_arg(field_out, step.index, step.options);
 			if (arg_result != result_code::success) {
 				result = arg_result;
 			}
+		}
+		return result;
+	}
 
-			// the iterrent text begin begins with the next character following the format directive's end
-			begin = iter = iter + 1;
+	template <typename CharT>
+	result_code write_format_step(basic_format_writer<CharT>& out, format_step<CharT> const& step, basic_format_arg_list<CharT> const& args) {
+		return write_format_step(out, step, args, out);
+	}
 
-			// if we continue to receive {} then the next index will be the next one after the last one used
-			next_index = index + 1;
-		}
+	template <typename CharT>
+	FORMATXX_PUBLIC result_code FORMATXX_API format_impl(basic_format_writer<CharT>& out, basic_string_view<CharT> format, basic_format_arg_list<CharT> args) {
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+		tracked_format_scope const tracking_scope(format.data(), format.size() * sizeof(CharT));
+#endif
 
-		// write out tail end of format string
-		if (iter > begin) {
-			out.write({ begin, iter });
+		unsigned next_index = 0;
+		result_code result = result_code::success;
+
+		CharT const* iter = format.data();
+		CharT const* const end = iter + format.size();
+
+		format_step<CharT> step;
+		while (iter < end) {
+			iter = parse_format_step(iter, end, next_index, step);
+
+			result_code const step_result = write_format_step(out, step, args);
+			if (step_result != result_code::success) {
+				result = step_result;
+			}
 		}
 
 		return result;
@@ -0,0 +1,115 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_DETAIL_FORMAT_SESSION_IMPL_H)
+#define _guard_FORMATXX_DETAIL_FORMAT_SESSION_IMPL_H
+#pragma once
+
+#include "formatxx/format_session.h"
+#include "format_impl.h"
+
+namespace formatxx::_detail {
+	template <typename CharT> class session_window;
+}
+
+/// Writer over the caller's buffer that first discards output already delivered by an earlier resume.
+template <typename CharT>
+class formatxx::_detail::session_window final : public basic_format_writer<CharT> {
+public:
+	session_window(CharT* buffer, std::size_t capacity) noexcept : _buffer(buffer), _capacity(capacity) {}
+
+	void write(basic_string_view<CharT> str) override {
+		std::size_t offset = 0;
+		if (_skip != 0) {
+			offset = _skip < str.size() ? _skip : str.size();
+			_skip -= offset;
+		}
+
+		std::size_t const remaining = str.size() - offset;
+		std::size_t const room = _capacity - _size;
+		std::size_t const count = remaining < room ? remaining : room;
+
+		for (std::size_t index = 0; index != count; ++index) {
+			_buffer[_size + index] = str[offset + index];
+		}
+		_size += count;
+
+		if (count != remaining) {
+			_full = true;
+		}
+	}
+
+	void skip(std::size_t count) noexcept { _skip = count; }
+	std::size_t size() const noexcept { return _size; }
+	bool full() const noexcept { return _full; }
+
+private:
+	CharT* _buffer = nullptr;
+	std::size_t _capacity = 0;
+	std::size_t _size = 0;
+	std::size_t _skip = 0;
+	bool _full = false;
+};
+
+template <typename CharT>
+FORMATXX_PUBLIC formatxx::result_code FORMATXX_API formatxx::_detail::format_session_state<CharT>::resume(CharT* buffer, std::size_t capacity, basic_format_arg_list<CharT> args) {
+	session_window<CharT> window(buffer, capacity);
+
+	format_step<CharT> step;
+	while (_cursor < _end) {
+		unsigned next_index = _next_index;
+		CharT const* const next = parse_format_step(_cursor, _end, next_index, step);
+
+		// a step interrupted by the last resume is formatted again, skipping what was already delivered
+		std::size_t const before = window.size();
+		window.skip(_skip);
+
+		result_code const result = write_format_step<CharT>(window, step, args);
+
+		if (window.full()) {
+			_skip += window.size() - before;
+			_size = window.size();
+			return result_code::out_of_space;
+		}
+
+		if (result != result_code::success) {
+			_result = result;
+		}
+		_cursor = next;
+		_next_index = next_index;
+		_skip = 0;
+	}
+
+	_size = window.size();
+	return _result;
+}
+
+#endif // _guard_FORMATXX_DETAIL_FORMAT_SESSION_IMPL_H
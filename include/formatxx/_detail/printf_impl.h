@@ -38,6 +38,10 @@ namespace formatxx::_detail {
 
 	template <typename CharT>
 	FORMATXX_PUBLIC result_code FORMATXX_API printf_impl(basic_format_writer<CharT>& out, basic_string_view<CharT> format, basic_format_arg_list<CharT> args) {
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+		tracked_format_scope const tracking_scope(format.data(), format.size() * sizeof(CharT));
+#endif
+
 		unsigned next_index = 0;
 		result_code result = result_code::success;
 
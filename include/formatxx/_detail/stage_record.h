@@ -0,0 +1,64 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_DETAIL_STAGE_RECORD_H)
+#define _guard_FORMATXX_DETAIL_STAGE_RECORD_H
+#pragma once
+
+#include "formatxx/format.h"
+#include "formatxx/inline_string.h"
+#include "formatxx/_detail/append_writer.h"
+
+namespace formatxx::_detail {
+    template <typename CharT, std::size_t Capacity, typename FormatT, typename... Args> constexpr result_code stage_format(inline_string<CharT, Capacity>& record, FormatT const& format, Args const& ... args);
+    template <typename CharT, std::size_t Capacity, typename FormatT, typename... Args> constexpr result_code stage_printf(inline_string<CharT, Capacity>& record, FormatT const& format, Args const& ... args);
+
+    template <typename CharT, std::size_t Capacity> constexpr result_code stage_result(inline_string<CharT, Capacity> const& record, result_code result) noexcept {
+        return result == result_code::success && record.truncated() ? result_code::out_of_space : result;
+    }
+}
+
+/// Format a whole record into fixed storage before it is copied out.
+/// @returns result_code::out_of_space if the record was cut short, else the formatting result.
+template <typename CharT, std::size_t Capacity, typename FormatT, typename... Args>
+constexpr formatxx::result_code formatxx::_detail::stage_format(inline_string<CharT, Capacity>& record, FormatT const& format, Args const& ... args) {
+    append_writer<inline_string<CharT, Capacity>> writer(record);
+    return stage_result(record, format_to(writer, format, args...));
+}
+
+/// Format a whole record into fixed storage before it is copied out, using printf syntax.
+/// @returns result_code::out_of_space if the record was cut short, else the formatting result.
+template <typename CharT, std::size_t Capacity, typename FormatT, typename... Args>
+constexpr formatxx::result_code formatxx::_detail::stage_printf(inline_string<CharT, Capacity>& record, FormatT const& format, Args const& ... args) {
+    append_writer<inline_string<CharT, Capacity>> writer(record);
+    return stage_result(record, printf_to(writer, format, args...));
+}
+
+#endif // !defined(_guard_FORMATXX_DETAIL_STAGE_RECORD_H)
@@ -0,0 +1,119 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_DETAIL_STRUCTURED_IMPL_H)
+#define _guard_FORMATXX_DETAIL_STRUCTURED_IMPL_H
+#pragma once
+
+#include "formatxx/structured.h"
+#include "format_impl.h"
+
+namespace formatxx::_detail {
+	template <typename CharT> class field_tee_writer;
+}
+
+/// Writer that passes a field's rendered text to both the message and the field sink.
+template <typename CharT>
+class formatxx::_detail::field_tee_writer final : public basic_format_writer<CharT> {
+public:
+	field_tee_writer(basic_format_writer<CharT>& out, basic_field_sink<CharT>& sink) noexcept : _out(out), _sink(sink) {}
+
+	void write(basic_string_view<CharT> str) override {
+		_out.write(str);
+		_sink.value(str);
+	}
+
+private:
+	basic_format_writer<CharT>& _out;
+	basic_field_sink<CharT>& _sink;
+};
+
+namespace formatxx::_detail {
+
+	/// Numbers rendered in a form that is not a plain decimal literal are reported as strings.
+	template <typename CharT>
+	constexpr field_kind structured_kind(format_arg_type type, basic_format_options<CharT> const& options) noexcept {
+		field_kind const kind = field_kind_of(type);
+		if (kind != field_kind::integer && kind != field_kind::floating) {
+			return kind;
+		}
+
+		bool const decimal = kind == field_kind::integer ?
+			options.specifier == 0 || options.specifier == 'd' || options.specifier == 'i' :
+			options.specifier != 'a' && options.specifier != 'A';
+		return decimal && !options.leading_zeroes && !options.alternate_form && options.sign == format_sign::negative ? kind : field_kind::string;
+	}
+
+	template <typename CharT>
+	FORMATXX_PUBLIC result_code FORMATXX_API structured_impl(basic_format_writer<CharT>& out, basic_field_sink<CharT>& sink, basic_string_view<CharT> format, basic_format_arg_list<CharT> args) {
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+		tracked_format_scope const tracking_scope(format.data(), format.size() * sizeof(CharT));
+#endif
+
+		unsigned next_index = 0;
+		result_code result = result_code::success;
+
+		CharT const* iter = format.data();
+		CharT const* const end = iter + format.size();
+
+		field_tee_writer<CharT> tee(out, sink);
+
+		sink.begin_record();
+
+		format_step<CharT> step;
+		while (iter < end) {
+			iter = parse_format_step(iter, end, next_index, step);
+
+			result_code step_result;
+			format_arg_type const type = step.field ? args.arg_type(step.index) : format_arg_type::unknown;
+			if (type == format_arg_type::unknown) {
+				// missing or unformattable arguments produce no field
+				step_result = write_format_step(out, step, args);
+			}
+			else {
+				sink.begin_field(step.name, step.index, structured_kind(type, step.options));
+				step_result = write_format_step(out, step, args, tee);
+				sink.end_field();
+			}
+
+			if (step_result != result_code::success) {
+				result = step_result;
+			}
+		}
+
+		sink.end_record();
+
+		return result;
+	}
+
+} // namespace formatxx::_detail
+
+#endif // _guard_FORMATXX_DETAIL_STRUCTURED_IMPL_H
@@ -0,0 +1,138 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_ALLOCATION_TRACKING_H)
+#define _guard_FORMATXX_ALLOCATION_TRACKING_H
+#pragma once
+
+// Allocation tracking is opt-in; build with FORMATXX_TRACK_ALLOCATIONS defined (the
+// FORMATXX_TRACK_ALLOCATIONS CMake option) to count the allocations made by the library's
+// own buffers and by strings and containers grown through the provided writers.
+
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+
+#include "formatxx/_detail/config.h"
+#include <litexx/string_view.h>
+#include <cstddef>
+#include <type_traits>
+
+namespace formatxx {
+    struct allocation_stats;
+    class allocation_scope;
+
+    FORMATXX_PUBLIC allocation_stats FORMATXX_API allocation_totals() noexcept;
+    FORMATXX_PUBLIC void FORMATXX_API reset_allocation_stats() noexcept;
+
+    template <typename CharT> allocation_stats allocations_for(litexx::basic_string_view<CharT> format) noexcept;
+}
+
+/// Count and size of tracked allocations.
+struct formatxx::allocation_stats {
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+};
+
+/// @internal
+namespace formatxx::_detail {
+    FORMATXX_PUBLIC void FORMATXX_API track_allocation(std::size_t bytes) noexcept;
+    FORMATXX_PUBLIC void const* FORMATXX_API exchange_tracked_format(void const* format, std::size_t bytes, std::size_t* previous_bytes) noexcept;
+    FORMATXX_PUBLIC allocation_stats FORMATXX_API tracked_format_stats(void const* format, std::size_t bytes) noexcept;
+
+    /// Attributes allocations made while alive to the given format string.
+    class tracked_format_scope {
+    public:
+        tracked_format_scope(void const* format, std::size_t bytes) noexcept : _previous(exchange_tracked_format(format, bytes, &_previous_bytes)) {}
+        ~tracked_format_scope() { exchange_tracked_format(_previous, _previous_bytes, &_previous_bytes); }
+
+        tracked_format_scope(tracked_format_scope const&) = delete;
+        tracked_format_scope& operator=(tracked_format_scope const&) = delete;
+
+    private:
+        std::size_t _previous_bytes = 0;
+        void const* _previous = nullptr;
+    };
+
+    template <typename T, typename = void>
+    struct has_capacity : std::false_type {};
+    template <typename T>
+    struct has_capacity<T, std::void_t<decltype(std::declval<T const&>().capacity())>> : std::true_type {};
+
+    // containers that report their own allocations, such as small_string
+    template <typename T, typename = void>
+    struct tracks_own_allocations : std::false_type {};
+    template <typename T>
+    struct tracks_own_allocations<T, std::void_t<typename T::tracks_allocations>> : std::true_type {};
+
+    /// Detect growth of a container across an operation by watching its capacity.
+    template <typename ContainerT, typename OperationT>
+    void track_capacity_change(ContainerT& container, OperationT&& operation) {
+        if constexpr (has_capacity<ContainerT>::value && !tracks_own_allocations<ContainerT>::value) {
+            auto const before = container.capacity();
+            operation();
+            if (container.capacity() != before) {
+                track_allocation(sizeof(typename ContainerT::value_type) * container.capacity());
+            }
+        }
+        else {
+            operation();
+        }
+    }
+}
+
+/// Measures the allocations made on the calling thread since construction.
+class formatxx::allocation_scope {
+public:
+    allocation_scope() noexcept : _start(allocation_totals()) {}
+
+    allocation_stats stats() const noexcept {
+        allocation_stats const now = allocation_totals();
+        return { now.count - _start.count, now.bytes - _start.bytes };
+    }
+
+private:
+    allocation_stats _start;
+};
+
+/// Look up the allocations made on the calling thread while formatting the given format string.
+/// @param format Format string text; matched by content.
+/// @returns the count and size of allocations attributed to the format string.
+template <typename CharT>
+formatxx::allocation_stats formatxx::allocations_for(litexx::basic_string_view<CharT> format) noexcept {
+    return _detail::tracked_format_stats(format.data(), format.size() * sizeof(CharT));
+}
+
+#   define FORMATXX_TRACK_ALLOCATION(bytes) (::formatxx::_detail::track_allocation(bytes))
+#   define FORMATXX_TRACK_CAPACITY_CHANGE(container, ...) (::formatxx::_detail::track_capacity_change((container), [&] { __VA_ARGS__; }))
+#else
+#   define FORMATXX_TRACK_ALLOCATION(bytes) ((void)0)
+#   define FORMATXX_TRACK_CAPACITY_CHANGE(container, ...) (__VA_ARGS__)
+#endif // defined(FORMATXX_TRACK_ALLOCATIONS)
+
+#endif // !defined(_guard_FORMATXX_ALLOCATION_TRACKING_H)
@@ -0,0 +1,164 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_ASYNC_LOGGER_H)
+#define _guard_FORMATXX_ASYNC_LOGGER_H
+#pragma once
+
+#include "formatxx/format_record.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace formatxx {
+    class async_logger;
+
+    struct async_logger_options;
+    enum class overflow_policy : unsigned char;
+}
+
+namespace formatxx::_detail {
+    class async_logger_worker;
+}
+
+/// What an async_logger does with a record when its queue is full.
+enum class formatxx::overflow_policy : unsigned char {
+    /// wait for the consumer to free a slot
+    block,
+    /// discard the record
+    drop,
+    /// discard the record and count it in dropped()
+    drop_and_count
+};
+
+/// Options for async_logger.
+struct formatxx::async_logger_options {
+    /// number of queued records; rounded up to a power of two
+    std::size_t queue_size = 1024;
+    /// bytes available to each captured record; larger records are dropped and counted
+    std::size_t slot_size = 256;
+    overflow_policy overflow = overflow_policy::block;
+    /// written to the sink after each record
+    string_view separator = "\n";
+};
+
+/// Logger that captures arguments on the calling thread and formats them on a background thread.
+///
+/// Producers capture each record (see capture_format) directly into a slot of a preallocated
+/// bounded multi-producer queue, costing roughly a copy of the arguments. A consumer thread
+/// renders records in queue order into the sink, which must not be used elsewhere while the
+/// logger runs. Custom format_value overloads are invoked on the consumer thread.
+class formatxx::async_logger {
+public:
+    FORMATXX_PUBLIC explicit FORMATXX_API async_logger(format_writer& sink, async_logger_options const& options = {});
+    FORMATXX_PUBLIC FORMATXX_API ~async_logger();
+
+    async_logger(async_logger const&) = delete;
+    async_logger& operator=(async_logger const&) = delete;
+
+    /// Queue a record for formatting.
+    ///
+    /// Arguments are copied, but the format string is referenced and read later on the
+    /// consumer thread, so it must outlive the logger's processing of the record; string
+    /// literals do. Only character arrays and pointers are accepted, to keep temporary
+    /// owning strings out.
+    /// @returns result_code::out_of_space if the record was dropped.
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args) noexcept;
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args) noexcept;
+
+    /// Wait until every record queued before the call has been written to the sink.
+    FORMATXX_PUBLIC void FORMATXX_API flush() noexcept;
+
+    /// Write out all queued records and stop the consumer thread. Later records are dropped
+    /// and counted.
+    FORMATXX_PUBLIC void FORMATXX_API shutdown() noexcept;
+
+    /// Records dropped under overflow_policy::drop_and_count, for being too large, or after shutdown.
+    std::uint64_t dropped() const noexcept { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    friend _detail::async_logger_worker;
+
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        std::uint32_t size;
+    };
+
+    static constexpr std::size_t cell_header = (sizeof(cell) + record_alignment - 1) / record_alignment * record_alignment;
+
+    cell& _cell(std::size_t position) const noexcept { return *reinterpret_cast<cell*>(_cells + (position & _mask) * _stride); }
+    static unsigned char* _data(cell& slot) noexcept { return reinterpret_cast<unsigned char*>(&slot) + cell_header; }
+
+    FORMATXX_PUBLIC cell* FORMATXX_API _claim() noexcept;
+    FORMATXX_PUBLIC void FORMATXX_API _publish(cell& slot, std::size_t size) noexcept;
+
+    unsigned char* _cells = nullptr;
+    std::size_t _mask = 0;
+    std::size_t _stride = 0;
+    std::size_t _slot_size = 0;
+    overflow_policy _overflow = overflow_policy::block;
+    _detail::async_logger_worker* _worker = nullptr;
+
+    alignas(64) std::atomic<std::size_t> _enqueue = 0;
+    alignas(64) std::atomic<std::size_t> _dequeue = 0;
+    alignas(64) std::atomic<std::uint64_t> _dropped = 0;
+    std::atomic<bool> _sleeping = false;
+    std::atomic<bool> _stopped = false;
+};
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::async_logger::format(FormatT const& format, Args const& ... args) noexcept {
+    static_assert(std::is_array_v<FormatT> || std::is_pointer_v<FormatT>, "the format string is read later on the consumer thread; pass a string literal or other long-lived character array");
+
+    cell* const slot = _claim();
+    if (slot == nullptr) {
+        return result_code::out_of_space;
+    }
+
+    std::size_t const size = capture_format(_data(*slot), _slot_size, format, args...);
+    _publish(*slot, size);
+    return size != 0 ? result_code::success : result_code::out_of_space;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::async_logger::printf(FormatT const& format, Args const& ... args) noexcept {
+    static_assert(std::is_array_v<FormatT> || std::is_pointer_v<FormatT>, "the format string is read later on the consumer thread; pass a string literal or other long-lived character array");
+
+    cell* const slot = _claim();
+    if (slot == nullptr) {
+        return result_code::out_of_space;
+    }
+
+    std::size_t const size = capture_printf(_data(*slot), _slot_size, format, args...);
+    _publish(*slot, size);
+    return size != 0 ? result_code::success : result_code::out_of_space;
+}
+
+#endif // !defined(_guard_FORMATXX_ASYNC_LOGGER_H)
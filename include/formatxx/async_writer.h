@@ -0,0 +1,123 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_ASYNC_WRITER_H)
+#define _guard_FORMATXX_ASYNC_WRITER_H
+#pragma once
+
+#include "formatxx/writers.h"
+
+namespace formatxx {
+    class async_fd_writer;
+
+    struct async_writer_options;
+}
+
+namespace formatxx::_detail {
+    class async_backend;
+}
+
+/// Options for async_fd_writer.
+struct formatxx::async_writer_options {
+    /// size of each output buffer
+    std::size_t buffer_size = 64 * 1024;
+    /// number of buffers, bounding how much output may be in flight at once
+    unsigned buffer_count = 4;
+    /// when every buffer is in flight, wait for one to complete (true) or drop output (false)
+    bool block_when_full = true;
+};
+
+/// Writer that hands filled buffers to a file descriptor asynchronously.
+///
+/// Output is copied into one of a fixed set of buffers; full buffers are submitted through
+/// io_uring when the library is built with liburing support and the kernel allows it, or
+/// otherwise to a background thread performing blocking writes. The formatting thread only
+/// waits when every buffer is in flight, or never when block_when_full is false.
+///
+/// A writer must be used by one thread at a time.
+class formatxx::async_fd_writer final : public formatxx::format_writer {
+public:
+    async_fd_writer() noexcept = default;
+    ~async_fd_writer() { close(); }
+
+    async_fd_writer(async_fd_writer const&) = delete;
+    async_fd_writer& operator=(async_fd_writer const&) = delete;
+
+    FORMATXX_PUBLIC result_code FORMATXX_API open(int fd, async_writer_options const& options = {});
+    FORMATXX_PUBLIC result_code FORMATXX_API close() noexcept;
+
+    void write(string_view str) override;
+
+    /// Submit the partially filled buffer without waiting for it to be written.
+    FORMATXX_PUBLIC void FORMATXX_API flush() noexcept;
+
+    /// Submit the partially filled buffer and wait for all submitted output to be written.
+    /// @returns the first error encountered by this writer, if any.
+    FORMATXX_PUBLIC result_code FORMATXX_API fence() noexcept;
+
+    FORMATXX_PUBLIC result_code FORMATXX_API result() const noexcept;
+
+    /// Bytes discarded because no buffer was available.
+    std::size_t dropped_bytes() const noexcept { return _dropped; }
+
+    /// True when buffers are submitted through io_uring rather than a background thread.
+    FORMATXX_PUBLIC bool FORMATXX_API uses_io_uring() const noexcept;
+
+private:
+    FORMATXX_PUBLIC bool FORMATXX_API _acquire() noexcept;
+    FORMATXX_PUBLIC void FORMATXX_API _submit() noexcept;
+
+    _detail::async_backend* _backend = nullptr;
+    char* _current = nullptr;
+    std::size_t _used = 0;
+    std::size_t _capacity = 0;
+    std::size_t _dropped = 0;
+    unsigned _index = 0;
+    bool _block = true;
+};
+
+inline void formatxx::async_fd_writer::write(string_view str) {
+    while (!str.empty()) {
+        if (_current == nullptr && !_acquire()) {
+            _dropped += str.size();
+            return;
+        }
+
+        std::size_t const copied = _detail::copy_clamped(_current + _used, _current + _capacity, str);
+        _used += copied;
+        str = string_view(str.data() + copied, str.size() - copied);
+
+        if (_used == _capacity) {
+            _submit();
+        }
+    }
+}
+
+#endif // !defined(_guard_FORMATXX_ASYNC_WRITER_H)
@@ -0,0 +1,303 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_BINLOG_H)
+#define _guard_FORMATXX_BINLOG_H
+#pragma once
+
+#include "formatxx/format_record.h"
+#include "formatxx/small_string.h"
+#include "formatxx/_detail/append_writer.h"
+#include <cstdint>
+
+namespace formatxx {
+    class binlog_writer;
+    class binlog_decoder;
+
+    /// Version of the binary log format written by binlog_writer.
+    constexpr std::uint8_t binlog_version = 1;
+}
+
+namespace formatxx::_detail {
+    class binlog_encoder;
+    struct binlog_dictionary;
+
+    /// Entry tags in a binary log; see binlog_writer.
+    enum class binlog_entry : std::uint8_t {
+        define = 1,
+        record = 2
+    };
+
+    constexpr char binlog_magic[4] = { 'F', 'X', 'B', 'L' };
+    constexpr std::size_t binlog_header_size = 8;
+}
+
+/// Accumulates encoded bytes, passing them to the sink in blocks.
+class formatxx::_detail::binlog_encoder {
+public:
+    explicit binlog_encoder(format_writer& sink) noexcept : _sink(sink) {}
+    ~binlog_encoder() { flush(); }
+
+    binlog_encoder(binlog_encoder const&) = delete;
+    binlog_encoder& operator=(binlog_encoder const&) = delete;
+
+    void byte(std::uint8_t value) noexcept {
+        if (_size == sizeof(_buffer)) {
+            flush();
+        }
+        _buffer[_size++] = static_cast<char>(value);
+    }
+
+    void varint(std::uint64_t value) noexcept {
+        while (value >= 0x80) {
+            byte(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        byte(static_cast<std::uint8_t>(value));
+    }
+
+    void zigzag(std::int64_t value) noexcept {
+        varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void fixed(std::uint64_t value, unsigned size) noexcept {
+        for (unsigned index = 0; index != size; ++index) {
+            byte(static_cast<std::uint8_t>(value >> (index * 8)));
+        }
+    }
+
+    void bytes(char const* data, std::size_t size) noexcept {
+        if (size > sizeof(_buffer) - _size) {
+            flush();
+            if (size >= sizeof(_buffer)) {
+                _sink.write(string_view(data, size));
+                return;
+            }
+        }
+        std::memcpy(_buffer + _size, data, size);
+        _size += size;
+    }
+
+    void flush() noexcept {
+        if (_size != 0) {
+            _sink.write(string_view(_buffer, _size));
+            _size = 0;
+        }
+    }
+
+    template <typename T> void arg(T const& value);
+
+private:
+    template <typename StringCharT> void _string(StringCharT const* data, std::size_t length);
+
+    format_writer& _sink;
+    std::size_t _size = 0;
+    char _buffer[256];
+};
+
+/// Writes log records as compact binary entries instead of text.
+///
+/// A log starts with an 8-byte header: the magic "FXBL", the format version, and three
+/// reserved bytes. It is followed by entries, each starting with a binlog_entry tag:
+///
+/// - define: varint id, style byte, varint length, format string bytes. Each format string
+///   is interned and defined once, before the first record using it.
+/// - record: varint id, argument count byte, then per argument its format_arg_type tag
+///   byte and value: integers as varints (signed ones zigzag-encoded), floating point as
+///   raw little-endian bytes, strings as a varint length and their characters.
+///
+/// Format strings are interned by address and checked against a copy of their text, so
+/// each address they appear at is defined separately; those with static storage duration,
+/// as string literals have, are defined once. Types with a format_value overload, enums
+/// and pointers among them, are rendered to text in full when the record is written.
+/// A writer must be used by one thread at a time.
+class formatxx::binlog_writer {
+public:
+    /// @param sink Receives the encoded bytes.
+    /// @param dictionary_capacity Most distinct format strings interned.
+    FORMATXX_PUBLIC explicit FORMATXX_API binlog_writer(format_writer& sink, std::size_t dictionary_capacity = 1024);
+    FORMATXX_PUBLIC FORMATXX_API ~binlog_writer();
+
+    binlog_writer(binlog_writer const&) = delete;
+    binlog_writer& operator=(binlog_writer const&) = delete;
+
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args);
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args);
+
+    /// Number of format strings defined so far.
+    std::size_t dictionary_size() const noexcept { return _next_id; }
+
+private:
+    template <typename... Args> result_code _record(string_view format, _detail::record_style style, Args const& ... args);
+
+    /// Look up the id of a format string, defining it if new.
+    /// @returns false if the dictionary is full.
+    FORMATXX_PUBLIC bool FORMATXX_API _intern(string_view format, _detail::record_style style, std::uint64_t& id);
+
+    format_writer& _sink;
+    _detail::binlog_dictionary* _dictionary = nullptr;
+    std::uint64_t _next_id = 0;
+};
+
+/// Rebuilds text from a binary log written by binlog_writer.
+class formatxx::binlog_decoder {
+public:
+    FORMATXX_PUBLIC FORMATXX_API binlog_decoder();
+    FORMATXX_PUBLIC FORMATXX_API ~binlog_decoder();
+
+    binlog_decoder(binlog_decoder const&) = delete;
+    binlog_decoder& operator=(binlog_decoder const&) = delete;
+
+    /// Decode a complete log, writing each record followed by separator.
+    /// @returns result_code::malformed_input on a corrupt or unsupported log.
+    FORMATXX_PUBLIC result_code FORMATXX_API decode(string_view log, format_writer& out, string_view separator = "\n");
+
+    /// Decode the next piece of a log as it is read, writing each complete record. Only an
+    /// entry split across pieces is held until the next call.
+    /// @returns result_code::malformed_input on a corrupt or unsupported log.
+    FORMATXX_PUBLIC result_code FORMATXX_API feed(string_view input, format_writer& out, string_view separator = "\n");
+
+    /// End the log given to feed(), readying the decoder for another.
+    /// @returns result_code::malformed_input if the log ended part way through an entry.
+    FORMATXX_PUBLIC result_code FORMATXX_API finish() noexcept;
+
+private:
+    struct state;
+    state* _state = nullptr;
+};
+
+template <typename T>
+void formatxx::_detail::binlog_encoder::arg(T const& value) {
+    constexpr format_arg_type type = type_of<T>::value;
+
+    if constexpr (type == format_arg_type::char_string || type == format_arg_type::wchar_string) {
+        using string_char = std::remove_cv_t<std::remove_pointer_t<T>>;
+        std::size_t length = 0;
+        if (value != nullptr) {
+            while (value[length] != string_char{}) {
+                ++length;
+            }
+        }
+        _string(value, length);
+    }
+    else if constexpr (type == format_arg_type::single_float || type == format_arg_type::double_float) {
+        byte(static_cast<std::uint8_t>(type));
+        std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t> bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        fixed(bits, sizeof(bits));
+    }
+    else if constexpr (type == format_arg_type::boolean) {
+        byte(static_cast<std::uint8_t>(type));
+        byte(value ? 1 : 0);
+    }
+    else if constexpr (type == format_arg_type::null_pointer) {
+        byte(static_cast<std::uint8_t>(type));
+    }
+    else if constexpr (type == format_arg_type::void_pointer) {
+        byte(static_cast<std::uint8_t>(type));
+        varint(reinterpret_cast<std::uintptr_t>(value));
+    }
+    else if constexpr (type == format_arg_type::char_t || type == format_arg_type::wchar) {
+        // character signedness varies by platform, so characters are always sent unsigned
+        byte(static_cast<std::uint8_t>(type));
+        varint(static_cast<std::make_unsigned_t<T>>(value));
+    }
+    else if constexpr (type != format_arg_type::unknown) {
+        byte(static_cast<std::uint8_t>(type));
+        if constexpr (std::is_signed_v<T>) {
+            zigzag(static_cast<std::int64_t>(value));
+        }
+        else {
+            varint(static_cast<std::uint64_t>(value));
+        }
+    }
+    else if constexpr (is_capturable_string_v<T, char>) {
+        _string(value.data(), value.size());
+    }
+    else if constexpr (has_format_value<char, T>::value) {
+        // no wire representation; send the default rendering as text, in full
+        small_string<char, 256> text;
+        append_writer<small_string<char, 256>> writer(text);
+        format_value(writer, value, format_options{});
+        _string(text.data(), text.size());
+    }
+    else if constexpr (std::is_pointer_v<T>) {
+        arg(static_cast<void const*>(value));
+    }
+    else {
+        static_assert(std::is_enum_v<T>, "type cannot be written to a binary log");
+        arg(static_cast<std::underlying_type_t<T>>(value));
+    }
+}
+
+template <typename StringCharT>
+void formatxx::_detail::binlog_encoder::_string(StringCharT const* data, std::size_t length) {
+    if constexpr (std::is_same_v<StringCharT, char>) {
+        byte(static_cast<std::uint8_t>(format_arg_type::char_string));
+        varint(length);
+        bytes(data, length);
+    }
+    else {
+        byte(static_cast<std::uint8_t>(format_arg_type::wchar_string));
+        varint(length);
+        for (std::size_t index = 0; index != length; ++index) {
+            varint(static_cast<std::make_unsigned_t<wchar_t>>(data[index]));
+        }
+    }
+}
+
+template <typename... Args>
+formatxx::result_code formatxx::binlog_writer::_record(string_view format, _detail::record_style style, Args const& ... args) {
+    static_assert(sizeof...(Args) <= max_record_args, "too many arguments for a binary log record");
+
+    std::uint64_t id = 0;
+    if (!_intern(format, style, id)) {
+        return result_code::out_of_space;
+    }
+
+    _detail::binlog_encoder encoder(_sink);
+    encoder.byte(static_cast<std::uint8_t>(_detail::binlog_entry::record));
+    encoder.varint(id);
+    encoder.byte(static_cast<std::uint8_t>(sizeof...(Args)));
+    (encoder.arg(static_cast<_detail::formattable_t<Args> const&>(args)), ...);
+    return result_code::success;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::binlog_writer::format(FormatT const& format, Args const& ... args) {
+    return _record(string_view(format), _detail::record_style::format, args...);
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::binlog_writer::printf(FormatT const& format, Args const& ... args) {
+    return _record(string_view(format), _detail::record_style::printf, args...);
+}
+
+#endif // !defined(_guard_FORMATXX_BINLOG_H)
@@ -0,0 +1,107 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_CATALOG_H)
+#define _guard_FORMATXX_CATALOG_H
+#pragma once
+
+#include "formatxx/format.h"
+#include <cstddef>
+
+namespace formatxx {
+    class format_catalog;
+}
+
+/// A set of format strings looked up by id, such as localized or operator-configured messages.
+///
+/// The catalog is loaded from a file that is memory-mapped rather than read, or from text
+/// the caller keeps alive. Each line holds one entry as `id=template`; blank lines and
+/// lines starting with # are ignored. Blanks around the id and before the template are
+/// dropped, and the template then runs verbatim to the end of the line.
+/// Loading builds a sorted index in a single allocation, without copying or parsing any
+/// template. Each template is parsed into segments the first time it is formatted, and
+/// later uses render the segments directly. Formatting may happen from any number of
+/// threads; the one-time parse is published atomically.
+class formatxx::format_catalog {
+public:
+    static constexpr std::size_t npos = ~std::size_t(0);
+
+    format_catalog() noexcept = default;
+    FORMATXX_PUBLIC FORMATXX_API ~format_catalog();
+
+    format_catalog(format_catalog const&) = delete;
+    format_catalog& operator=(format_catalog const&) = delete;
+
+    /// Map a catalog file and index its entries. Only supported on POSIX systems;
+    /// elsewhere fails with result_code::io_error.
+    FORMATXX_PUBLIC result_code FORMATXX_API open(char const* path) noexcept;
+
+    /// Index catalog text held by the caller, which must outlive the catalog.
+    FORMATXX_PUBLIC result_code FORMATXX_API assign(string_view contents) noexcept;
+
+    FORMATXX_PUBLIC void FORMATXX_API close() noexcept;
+
+    std::size_t size() const noexcept { return _count; }
+
+    /// Find the entry with the given id.
+    /// @returns the entry's index, or npos if there is none.
+    FORMATXX_PUBLIC std::size_t FORMATXX_API find(string_view id) const noexcept;
+
+    /// The id and unparsed template of an entry.
+    FORMATXX_PUBLIC string_view FORMATXX_API id(std::size_t index) const noexcept;
+    FORMATXX_PUBLIC string_view FORMATXX_API text(std::size_t index) const noexcept;
+
+    /// Format the template with the given id.
+    /// @returns result_code::out_of_range if there is no such entry, or any formatting error.
+    template <typename... Args>
+    result_code format_to(format_writer& writer, string_view id, Args const& ... args) const {
+        return _render(writer, find(id), { _detail::make_format_arg<char, _detail::formattable_t<Args>>(args)... });
+    }
+
+    /// Format the template at an index returned by find().
+    template <typename... Args>
+    result_code format_to(format_writer& writer, std::size_t index, Args const& ... args) const {
+        return _render(writer, index, { _detail::make_format_arg<char, _detail::formattable_t<Args>>(args)... });
+    }
+
+private:
+    struct entry;
+
+    FORMATXX_PUBLIC result_code FORMATXX_API _render(format_writer& writer, std::size_t index, _detail::basic_format_arg_list<char> args) const;
+    result_code _index(string_view contents) noexcept;
+
+    entry* _entries = nullptr;
+    std::size_t _count = 0;
+    void* _mapping = nullptr;
+    std::size_t _mapping_size = 0;
+};
+
+#endif // !defined(_guard_FORMATXX_CATALOG_H)
@@ -0,0 +1,188 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_CHUNKED_WRITER_H)
+#define _guard_FORMATXX_CHUNKED_WRITER_H
+#pragma once
+
+#include "formatxx/format.h"
+#include "formatxx/allocation_tracking.h"
+#include "formatxx/_detail/new_delete_allocator.h"
+#include <cstring>
+
+namespace formatxx::_detail {
+    template <typename CharT, std::size_t BlockSize>
+    struct basic_chunk {
+        basic_chunk* next;
+        std::size_t size;
+        CharT data[BlockSize];
+    };
+} // namespace formatxx::_detail
+
+namespace formatxx {
+    template <typename CharT, std::size_t BlockSize = 4096, typename AllocatorT = _detail::new_delete_allocator<_detail::basic_chunk<CharT, BlockSize>>> class chunked_writer;
+} // namespace formatxx
+
+/// Writer that appends into a list of fixed-size blocks, never moving text already written.
+///
+/// The output is exposed as a sequence of string slices (one per block) through chunks(),
+/// suitable for writev, hashing or compression, or can be copied out once with flatten().
+template <typename CharT, std::size_t BlockSize, typename AllocatorT>
+class formatxx::chunked_writer final : public formatxx::basic_format_writer<CharT>, private AllocatorT {
+    static_assert(BlockSize != 0);
+
+    using chunk_type = _detail::basic_chunk<CharT, BlockSize>;
+
+public:
+    using value_type = CharT;
+    using size_type = std::size_t;
+
+    /// Iterates over the written blocks as string slices.
+    class chunk_iterator {
+    public:
+        constexpr explicit chunk_iterator(chunk_type const* chunk) noexcept : _chunk(chunk) {}
+
+        constexpr basic_string_view<CharT> operator*() const noexcept { return { _chunk->data, _chunk->size }; }
+        constexpr chunk_iterator& operator++() noexcept { _chunk = _chunk->next; return *this; }
+
+        constexpr bool operator==(chunk_iterator rhs) const noexcept { return _chunk == rhs._chunk; }
+        constexpr bool operator!=(chunk_iterator rhs) const noexcept { return _chunk != rhs._chunk; }
+
+    private:
+        chunk_type const* _chunk = nullptr;
+    };
+
+    /// Range over the written blocks, in order.
+    class chunk_range {
+    public:
+        constexpr explicit chunk_range(chunk_type const* head) noexcept : _head(head) {}
+
+        constexpr chunk_iterator begin() const noexcept { return chunk_iterator(_head); }
+        constexpr chunk_iterator end() const noexcept { return chunk_iterator(nullptr); }
+
+    private:
+        chunk_type const* _head = nullptr;
+    };
+
+    chunked_writer() = default;
+    explicit chunked_writer(AllocatorT const& allocator) : AllocatorT(allocator) {}
+    ~chunked_writer() { clear(); }
+
+    chunked_writer(chunked_writer const&) = delete;
+    chunked_writer& operator=(chunked_writer const&) = delete;
+
+    void write(basic_string_view<CharT> str) override;
+
+    static constexpr size_type block_size() noexcept { return BlockSize; }
+
+    bool empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+
+    chunk_range chunks() const noexcept { return chunk_range(_head); }
+
+    /// Copy the written text into a buffer of at least size() characters.
+    void flatten_to(CharT* buffer) const noexcept;
+
+    /// Copy the written text into a newly created container supporting resize and data.
+    template <typename ContainerT> ContainerT flatten() const;
+
+    /// Free all blocks.
+    void clear() noexcept;
+
+private:
+    chunk_type* _head = nullptr;
+    chunk_type* _tail = nullptr;
+    size_type _size = 0;
+};
+
+template <typename CharT, std::size_t BlockSize, typename AllocatorT>
+void formatxx::chunked_writer<CharT, BlockSize, AllocatorT>::write(basic_string_view<CharT> str) {
+    CharT const* data = str.data();
+    size_type remaining = str.size();
+
+    while (remaining != 0) {
+        if (_tail == nullptr || _tail->size == BlockSize) {
+            chunk_type* const chunk = this->allocate(1);
+            FORMATXX_TRACK_ALLOCATION(sizeof(chunk_type));
+            chunk->next = nullptr;
+            chunk->size = 0;
+
+            if (_tail != nullptr) {
+                _tail->next = chunk;
+            }
+            else {
+                _head = chunk;
+            }
+            _tail = chunk;
+        }
+
+        size_type const available = BlockSize - _tail->size;
+        size_type const length = available < remaining ? available : remaining;
+
+        std::memcpy(_tail->data + _tail->size, data, sizeof(CharT) * length);
+        _tail->size += length;
+        _size += length;
+
+        data += length;
+        remaining -= length;
+    }
+}
+
+template <typename CharT, std::size_t BlockSize, typename AllocatorT>
+void formatxx::chunked_writer<CharT, BlockSize, AllocatorT>::flatten_to(CharT* buffer) const noexcept {
+    for (chunk_type const* chunk = _head; chunk != nullptr; chunk = chunk->next) {
+        std::memcpy(buffer, chunk->data, sizeof(CharT) * chunk->size);
+        buffer += chunk->size;
+    }
+}
+
+template <typename CharT, std::size_t BlockSize, typename AllocatorT>
+template <typename ContainerT>
+ContainerT formatxx::chunked_writer<CharT, BlockSize, AllocatorT>::flatten() const {
+    ContainerT result;
+    result.resize(_size);
+    flatten_to(result.data());
+    return result;
+}
+
+template <typename CharT, std::size_t BlockSize, typename AllocatorT>
+void formatxx::chunked_writer<CharT, BlockSize, AllocatorT>::clear() noexcept {
+    chunk_type* chunk = _head;
+    while (chunk != nullptr) {
+        chunk_type* const next = chunk->next;
+        this->deallocate(chunk, 1);
+        chunk = next;
+    }
+
+    _head = _tail = nullptr;
+    _size = 0;
+}
+
+#endif // !defined(_guard_FORMATXX_CHUNKED_WRITER_H)
@@ -0,0 +1,144 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_CONCURRENT_WRITER_H)
+#define _guard_FORMATXX_CONCURRENT_WRITER_H
+#pragma once
+
+#include "formatxx/format.h"
+#include "formatxx/inline_string.h"
+#include "formatxx/_detail/stage_record.h"
+#include <atomic>
+#include <cstring>
+
+namespace formatxx {
+    class concurrent_writer;
+}
+
+/// Collects whole records from many threads into one shared buffer without locking.
+///
+/// Each record is formatted onto the stack, then copied into a range reserved with a
+/// single fetch_add, so records never interleave. Records that do not fit are dropped
+/// and counted. Records longer than max_record_size are stored truncated and format()
+/// or printf() returns result_code::out_of_space.
+class formatxx::concurrent_writer {
+public:
+    static constexpr std::size_t max_record_size = 1024;
+
+    template <std::size_t Count>
+    explicit concurrent_writer(char(&buffer)[Count]) noexcept : concurrent_writer(buffer, Count) {}
+    concurrent_writer(char* buffer, std::size_t capacity) noexcept : _buffer(buffer), _capacity(capacity), _end(capacity) {}
+
+    concurrent_writer(concurrent_writer const&) = delete;
+    concurrent_writer& operator=(concurrent_writer const&) = delete;
+
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args);
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args);
+
+    /// Copy text in as a single record.
+    /// @returns result_code::out_of_space if the record was dropped.
+    result_code append(string_view text) noexcept;
+
+    /// Bytes of records reserved so far; may run ahead of committed() while threads copy.
+    std::size_t size() const noexcept;
+    /// Bytes of records completely copied in.
+    std::size_t committed() const noexcept { return _committed.load(std::memory_order_acquire); }
+    /// True when every reserved record has been copied in, making view() safe to read.
+    bool complete() const noexcept { return committed() == size(); }
+    std::size_t dropped() const noexcept { return _dropped.load(std::memory_order_relaxed); }
+
+    /// The records written so far; only meaningful when complete().
+    string_view view() const noexcept { return { _buffer, size() }; }
+
+    /// Forget all records. Not safe while other threads are writing.
+    void clear() noexcept;
+
+private:
+    void _drop(std::size_t offset) noexcept;
+
+    char* _buffer = nullptr;
+    std::size_t _capacity = 0;
+    std::atomic<std::size_t> _reserved = 0;
+    std::atomic<std::size_t> _committed = 0;
+    /// offset of the first record that failed to fit, bounding the usable prefix
+    std::atomic<std::size_t> _end = 0;
+    std::atomic<std::size_t> _dropped = 0;
+};
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::concurrent_writer::format(FormatT const& format, Args const& ... args) {
+    inline_string<char, max_record_size> staging;
+    result_code const result = _detail::stage_format(staging, format, args...);
+    result_code const appended = append(staging);
+    return appended != result_code::success ? appended : result;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::concurrent_writer::printf(FormatT const& format, Args const& ... args) {
+    inline_string<char, max_record_size> staging;
+    result_code const result = _detail::stage_printf(staging, format, args...);
+    result_code const appended = append(staging);
+    return appended != result_code::success ? appended : result;
+}
+
+inline formatxx::result_code formatxx::concurrent_writer::append(string_view text) noexcept {
+    std::size_t const offset = _reserved.fetch_add(text.size(), std::memory_order_relaxed);
+    if (text.size() > _capacity || offset > _capacity - text.size()) {
+        _drop(offset);
+        return result_code::out_of_space;
+    }
+
+    std::memcpy(_buffer + offset, text.data(), text.size());
+    _committed.fetch_add(text.size(), std::memory_order_release);
+    return result_code::success;
+}
+
+inline std::size_t formatxx::concurrent_writer::size() const noexcept {
+    std::size_t const reserved = _reserved.load(std::memory_order_acquire);
+    std::size_t const end = _end.load(std::memory_order_acquire);
+    return reserved < end ? reserved : end;
+}
+
+inline void formatxx::concurrent_writer::clear() noexcept {
+    _reserved.store(0, std::memory_order_relaxed);
+    _committed.store(0, std::memory_order_relaxed);
+    _end.store(_capacity, std::memory_order_relaxed);
+    _dropped.store(0, std::memory_order_relaxed);
+}
+
+inline void formatxx::concurrent_writer::_drop(std::size_t offset) noexcept {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+
+    // the failed range never holds a record; later successful records all lie before it
+    std::size_t end = _end.load(std::memory_order_relaxed);
+    while (offset < end && !_end.compare_exchange_weak(end, offset, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+#endif // !defined(_guard_FORMATXX_CONCURRENT_WRITER_H)
@@ -0,0 +1,136 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_CSV_WRITER_H)
+#define _guard_FORMATXX_CSV_WRITER_H
+#pragma once
+
+#include "formatxx/format.h"
+#include <cstddef>
+
+namespace formatxx {
+    class csv_exporter;
+
+    struct csv_options;
+}
+
+namespace formatxx::_detail {
+    /// Reads element row of a column of string-like values.
+    using csv_string_thunk = string_view(FORMATXX_API*)(void const* values, std::size_t row);
+
+    template <typename T>
+    string_view FORMATXX_API csv_string_at(void const* values, std::size_t row) noexcept {
+        T const& value = static_cast<T const*>(values)[row];
+        return { value.data(), value.size() };
+    }
+}
+
+/// Options for csv_exporter.
+struct formatxx::csv_options {
+    /// separates fields; use '\t' for TSV
+    char delimiter = ',';
+    /// ends each record; RFC 4180 specifies "\r\n"
+    string_view line_end = "\n";
+    /// write a first record holding the column names
+    bool header = true;
+};
+
+/// Writes struct-of-arrays data as CSV or TSV.
+///
+/// Each column is a contiguous array of integers, floating point values, or strings (any
+/// type with data() and size(), or char const*), plus the format options applied to every
+/// value in it. The formatting routine for each column is chosen once when writing starts
+/// rather than parsed and dispatched per value, and rows are assembled in a large block that
+/// is handed to the writer as a whole. String fields are quoted, with embedded quotes
+/// doubled, only when they contain the delimiter, a quote, or a line break. Columns are
+/// referenced, not copied, and must stay alive while the exporter is used.
+class formatxx::csv_exporter {
+public:
+    static constexpr std::size_t max_columns = 64;
+    static constexpr std::size_t block_size = 16 * 1024;
+
+    constexpr explicit csv_exporter(csv_options const& options = {}) noexcept : _options(options) {}
+
+    /// Add a column.
+    /// @param name Written in the header record.
+    /// @param values The column's values; all columns must have the same count.
+    /// @returns result_code::out_of_range if the count differs from earlier columns or the
+    ///     column limit is reached.
+    template <typename T>
+    result_code add_column(string_view name, T const* values, std::size_t count, format_options const& options = {}) noexcept;
+
+    /// Write the header record, if enabled, and every row.
+    FORMATXX_PUBLIC result_code FORMATXX_API write(format_writer& out) const;
+
+    std::size_t rows() const noexcept { return _rows; }
+    std::size_t columns() const noexcept { return _column_count; }
+
+private:
+    struct column {
+        string_view name;
+        void const* values = nullptr;
+        _detail::format_arg_type type = _detail::format_arg_type::unknown;
+        _detail::csv_string_thunk string_at = nullptr;
+        format_options options;
+    };
+
+    FORMATXX_PUBLIC result_code FORMATXX_API _add(column const& added, std::size_t count) noexcept;
+
+    csv_options _options;
+    std::size_t _rows = 0;
+    std::size_t _column_count = 0;
+    column _columns[max_columns];
+};
+
+template <typename T>
+formatxx::result_code formatxx::csv_exporter::add_column(string_view name, T const* values, std::size_t count, format_options const& options) noexcept {
+    column added;
+    added.name = name;
+    added.values = values;
+    added.options = options;
+
+    constexpr _detail::format_arg_type type = _detail::type_of<T>::value;
+    if constexpr (type != _detail::format_arg_type::unknown) {
+        static_assert(type != _detail::format_arg_type::wchar && type != _detail::format_arg_type::wchar_string, "csv_exporter writes narrow text only");
+        added.type = type;
+    }
+    else if constexpr (std::is_enum_v<T>) {
+        added.type = _detail::type_of<std::underlying_type_t<T>>::value;
+    }
+    else {
+        added.type = _detail::format_arg_type::custom;
+        added.string_at = &_detail::csv_string_at<T>;
+    }
+
+    return _add(added, count);
+}
+
+#endif // !defined(_guard_FORMATXX_CSV_WRITER_H)
@@ -0,0 +1,245 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_DYNAMIC_ARGS_H)
+#define _guard_FORMATXX_DYNAMIC_ARGS_H
+#pragma once
+
+#include "formatxx/format.h"
+#include "formatxx/small_string.h"
+#include <cstring>
+#include <memory>
+#include <new>
+
+namespace formatxx {
+    template <typename CharT, std::size_t InlineArgs = 16, std::size_t InlineChars = 256> class dynamic_format_arg_store;
+
+    template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+    result_code vformat_to(basic_format_writer<CharT>& writer, basic_string_view<CharT> format, dynamic_format_arg_store<CharT, InlineArgs, InlineChars>& store);
+    template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+    result_code vprintf_to(basic_format_writer<CharT>& writer, basic_string_view<CharT> format, dynamic_format_arg_store<CharT, InlineArgs, InlineChars>& store);
+}
+
+namespace formatxx::_detail {
+    template <typename T, typename CharT, typename V = void>
+    struct is_string_like { static constexpr bool value = false; };
+    template <typename T, typename CharT>
+    struct is_string_like<T, CharT, std::enable_if_t<std::is_same_v<litexx::remove_cvref_t<decltype(*std::declval<T const&>().data())>, CharT>, decltype(void(std::declval<T const&>().size()))>> {
+        static constexpr bool value = true;
+    };
+
+    /// Owned storage for one argument of a dynamic_format_arg_store.
+    struct dynamic_arg_value {
+        enum kind_type : unsigned char { copied, string, referenced };
+
+        /// a copied value, or for strings the view formatted in place of the text
+        alignas(8) unsigned char bytes[2 * sizeof(void*)];
+        /// position and length of a string's text in the store
+        std::size_t offset;
+        std::size_t length;
+        kind_type kind;
+    };
+}
+
+/// A list of format arguments built at runtime.
+///
+/// Primitive values and strings are copied into the store, so arguments can be added from
+/// temporaries, configuration, or script values and the store passed to vformat_to() or
+/// vprintf_to() later. Up to InlineArgs arguments and InlineChars characters of string
+/// data are held inline; beyond that the store allocates. Values of user-defined types are
+/// added by reference with push_back_ref() and must outlive the store's use.
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+class formatxx::dynamic_format_arg_store {
+public:
+    using size_type = std::size_t;
+
+    dynamic_format_arg_store() noexcept = default;
+    ~dynamic_format_arg_store() { _release(); }
+
+    dynamic_format_arg_store(dynamic_format_arg_store const&) = delete;
+    dynamic_format_arg_store& operator=(dynamic_format_arg_store const&) = delete;
+
+    /// Copy a primitive, enumeration or string into the store.
+    template <typename T> void push_back(T const& value);
+
+    /// Add a reference to a value formatted by its format_value.
+    template <typename T> void push_back_ref(T const& value);
+
+    void clear() noexcept {
+        _size = 0;
+        _strings.clear();
+    }
+
+    bool empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+
+    /// The arguments, for format_impl or printf_impl; invalidated by adding more arguments.
+    _detail::basic_format_arg_list<CharT> args() noexcept;
+
+private:
+    using value_type = _detail::dynamic_arg_value;
+
+    value_type& _push(_detail::basic_format_arg<CharT> const& arg, typename value_type::kind_type kind);
+    void _push_string(CharT const* data, size_type length);
+    void _release() noexcept;
+
+    _detail::basic_format_arg<CharT>* _args = _inline_args;
+    value_type* _values = _inline_values;
+    size_type _size = 0;
+    size_type _capacity = InlineArgs;
+    small_string<CharT, InlineChars> _strings;
+
+    _detail::basic_format_arg<CharT> _inline_args[InlineArgs];
+    value_type _inline_values[InlineArgs];
+};
+
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+template <typename T>
+void formatxx::dynamic_format_arg_store<CharT, InlineArgs, InlineChars>::push_back(T const& value) {
+    using arg_type = std::remove_cv_t<_detail::formattable_t<T>>;
+    constexpr _detail::format_arg_type type = _detail::type_of<arg_type>::value;
+    constexpr _detail::format_arg_type string_type = std::is_same_v<CharT, char> ? _detail::format_arg_type::char_string : _detail::format_arg_type::wchar_string;
+
+    if constexpr (type == string_type) {
+        arg_type const pointer = value;
+        _push_string(pointer, pointer != nullptr ? litexx::basic_string_view<CharT>(pointer).size() : 0);
+    }
+    else if constexpr (type == _detail::format_arg_type::char_string || type == _detail::format_arg_type::wchar_string) {
+        static_assert(type == string_type, "only strings of the store's character type can be copied");
+    }
+    else if constexpr (type != _detail::format_arg_type::unknown || std::is_enum_v<arg_type>) {
+        static_assert(sizeof(arg_type) <= 8 && alignof(arg_type) <= 8, "argument too large for inline storage");
+
+        value_type& stored = _push({}, value_type::copied);
+        ::new (static_cast<void*>(stored.bytes)) arg_type(value);
+        _args[_size - 1] = _detail::make_format_arg<CharT, arg_type>(*std::launder(reinterpret_cast<arg_type const*>(stored.bytes)));
+    }
+    else if constexpr (_detail::is_string_like<arg_type, CharT>::value) {
+        _push_string(value.data(), value.size());
+    }
+    else {
+        static_assert(_detail::is_string_like<arg_type, CharT>::value, "only primitives and strings can be copied; use push_back_ref");
+    }
+}
+
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+template <typename T>
+void formatxx::dynamic_format_arg_store<CharT, InlineArgs, InlineChars>::push_back_ref(T const& value) {
+    _push(_detail::make_format_arg<CharT, T>(value), value_type::referenced);
+}
+
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+auto formatxx::dynamic_format_arg_store<CharT, InlineArgs, InlineChars>::args() noexcept -> _detail::basic_format_arg_list<CharT> {
+    // strings and copied values may have moved since they were added, so point their arguments at the current storage
+    for (size_type index = 0; index != _size; ++index) {
+        value_type& stored = _values[index];
+        if (stored.kind == value_type::string) {
+            // formatted as a view with its length, so embedded NULs are kept
+            auto* const view = std::launder(reinterpret_cast<basic_string_view<CharT>*>(stored.bytes));
+            *view = basic_string_view<CharT>(_strings.data() + stored.offset, stored.length);
+            _args[index] = _detail::make_format_arg<CharT, basic_string_view<CharT>>(*view);
+        }
+        else if (stored.kind == value_type::copied) {
+            _args[index] = _args[index].relocated(stored.bytes);
+        }
+    }
+
+    return { _args, _size };
+}
+
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+auto formatxx::dynamic_format_arg_store<CharT, InlineArgs, InlineChars>::_push(_detail::basic_format_arg<CharT> const& arg, typename value_type::kind_type kind) -> value_type& {
+    if (_size == _capacity) {
+        size_type const capacity = _capacity + (_capacity >> 1) + 1;
+
+        // held until both allocations succeed, so a throwing second new leaks nothing
+        std::unique_ptr<_detail::basic_format_arg<CharT>[]> args(new _detail::basic_format_arg<CharT>[capacity]);
+        auto* const values = new value_type[capacity];
+        FORMATXX_TRACK_ALLOCATION((sizeof(args[0]) + sizeof(*values)) * capacity);
+
+        for (size_type index = 0; index != _size; ++index) {
+            args[index] = _args[index];
+        }
+        std::memcpy(values, _values, sizeof(value_type) * _size);
+
+        _release();
+        _args = args.release();
+        _values = values;
+        _capacity = capacity;
+    }
+
+    value_type& stored = _values[_size];
+    stored.offset = 0;
+    stored.length = 0;
+    stored.kind = kind;
+    _args[_size] = arg;
+    ++_size;
+    return stored;
+}
+
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+void formatxx::dynamic_format_arg_store<CharT, InlineArgs, InlineChars>::_push_string(CharT const* data, size_type length) {
+    static_assert(sizeof(basic_string_view<CharT>) <= sizeof(value_type::bytes), "string view does not fit inline storage");
+
+    size_type const offset = _strings.size();
+    if (length != 0) {
+        _strings.append(data, length);
+    }
+
+    value_type& stored = _push({}, value_type::string);
+    stored.offset = offset;
+    stored.length = length;
+    ::new (static_cast<void*>(stored.bytes)) basic_string_view<CharT>();
+}
+
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+void formatxx::dynamic_format_arg_store<CharT, InlineArgs, InlineChars>::_release() noexcept {
+    if (_args != _inline_args) {
+        delete[] _args;
+        delete[] _values;
+    }
+}
+
+/// Write the string format using arguments from a dynamic store into a buffer.
+/// @returns a result code indicating any errors.
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+formatxx::result_code formatxx::vformat_to(basic_format_writer<CharT>& writer, basic_string_view<CharT> format, dynamic_format_arg_store<CharT, InlineArgs, InlineChars>& store) {
+    return _detail::format_impl(writer, format, store.args());
+}
+
+/// Write the printf format using arguments from a dynamic store into a buffer.
+/// @returns a result code indicating any errors.
+template <typename CharT, std::size_t InlineArgs, std::size_t InlineChars>
+formatxx::result_code formatxx::vprintf_to(basic_format_writer<CharT>& writer, basic_string_view<CharT> format, dynamic_format_arg_store<CharT, InlineArgs, InlineChars>& store) {
+    return _detail::printf_impl(writer, format, store.args());
+}
+
+#endif // !defined(_guard_FORMATXX_DYNAMIC_ARGS_H)
@@ -0,0 +1,120 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_FLIGHT_RECORDER_H)
+#define _guard_FORMATXX_FLIGHT_RECORDER_H
+#pragma once
+
+#include "formatxx/format.h"
+#include "formatxx/inline_string.h"
+#include "formatxx/_detail/stage_record.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace formatxx {
+    class flight_recorder;
+}
+
+namespace formatxx::_detail {
+    struct flight_slot;
+}
+
+/// Fixed-size in-memory ring that keeps the most recently formatted records.
+///
+/// Each record is formatted onto the stack, then copied into a run of fixed-size slots
+/// reserved with a single atomic increment, overwriting the oldest records. Recording
+/// never locks or allocates. Records longer than max_record_size are stored truncated
+/// and format() or printf() returns result_code::out_of_space.
+///
+/// dump() and for_each_record() visit the surviving records oldest first; records that
+/// are overwritten or still being written while visited are skipped. Neither allocates,
+/// so a recorder can be dumped from a crash handler.
+class formatxx::flight_recorder {
+public:
+    static constexpr std::size_t slot_size = 64;
+    static constexpr std::size_t max_record_size = 1024;
+
+    /// @param capacity Size of the ring in bytes, rounded up to whole slots.
+    FORMATXX_PUBLIC explicit FORMATXX_API flight_recorder(std::size_t capacity);
+    FORMATXX_PUBLIC FORMATXX_API ~flight_recorder();
+
+    flight_recorder(flight_recorder const&) = delete;
+    flight_recorder& operator=(flight_recorder const&) = delete;
+
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args);
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args);
+
+    /// Store text as a single record.
+    FORMATXX_PUBLIC void FORMATXX_API record(string_view text) noexcept;
+
+    /// Invoke callback(string_view) for each surviving record, oldest first.
+    template <typename CallbackT> void for_each_record(CallbackT&& callback) const;
+
+    /// Write each surviving record, oldest first, followed by separator.
+    FORMATXX_PUBLIC void FORMATXX_API dump(format_writer& out, string_view separator = "\n") const;
+
+    /// Size of the ring in bytes.
+    std::size_t capacity() const noexcept { return _slot_count * slot_size; }
+
+private:
+    using visit_thunk = void(*)(void* context, string_view record);
+
+    FORMATXX_PUBLIC void FORMATXX_API _visit(visit_thunk thunk, void* context) const noexcept;
+
+    _detail::flight_slot* _slots = nullptr;
+    std::uint64_t _slot_count = 0;
+    alignas(64) std::atomic<std::uint64_t> _head = 0;
+};
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::flight_recorder::format(FormatT const& format, Args const& ... args) {
+    inline_string<char, max_record_size> staging;
+    result_code const result = _detail::stage_format(staging, format, args...);
+    record(staging);
+    return result;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::flight_recorder::printf(FormatT const& format, Args const& ... args) {
+    inline_string<char, max_record_size> staging;
+    result_code const result = _detail::stage_printf(staging, format, args...);
+    record(staging);
+    return result;
+}
+
+template <typename CallbackT>
+void formatxx::flight_recorder::for_each_record(CallbackT&& callback) const {
+    using callback_type = std::remove_reference_t<CallbackT>;
+    _visit([](void* context, string_view record) { (*static_cast<callback_type*>(context))(record); },
+        const_cast<void*>(static_cast<void const*>(&callback)));
+}
+
+#endif // !defined(_guard_FORMATXX_FLIGHT_RECORDER_H)
@@ -34,28 +34,7 @@
 
 #include <type_traits>
 #include <litexx/string_view.h>
-
-#if !defined(FORMATXX_API)
-#	if defined(_WIN32)
-#		define FORMATXX_API __stdcall
-#	else
-#		define FORMATXX_API
-#	endif
-#endif
-
-#if defined(_WIN32) && !defined(FORMATXX_PUBLIC)
-#	if defined(FORMATXX_EXPORT)
-#		define FORMATXX_PUBLIC __declspec(dllexport)
-#	else
-#		define FORMATXX_PUBLIC
-#	endif
-#elif __GNUC__ >= 4 && !defined(FORMATXX_PUBLIC)
-#	if defined(FORMATXX_EXPORT)
-#		define FORMATXX_PUBLIC __attribute__((visibility("default")))
-#	else
-#		define FORMATXX_PUBLIC
-#	endif
-#endif
+#include "formatxx/_detail/config.h"
 
 namespace formatxx {
     template <typename CharT> using basic_string_view = litexx::basic_string_view<CharT>;
@@ -93,6 +72,7 @@ enum class formatxx::result_code : unsigned int {
     out_of_range,
     malformed_input,
     out_of_space,
+    io_error,
 };
 
 enum class formatxx::format_justify : unsigned char {
@@ -0,0 +1,177 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_FORMAT_BATCH_H)
+#define _guard_FORMATXX_FORMAT_BATCH_H
+#pragma once
+
+#include "formatxx/writers.h"
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+namespace formatxx {
+    struct format_batch_options;
+
+    template <typename CharT, typename FormatT, typename RangeT>
+    result_code format_batch(basic_format_writer<CharT>& writer, FormatT const& format, RangeT const& records, format_batch_options const& options = {});
+}
+
+namespace formatxx::_detail {
+    template <typename CharT> struct batch_slot;
+    template <typename CharT, typename IteratorT> struct batch_context;
+
+    /// Callback run by run_batch for one chunk, using the buffer at the given slot.
+    using batch_thunk = void(FORMATXX_API*)(void* context, std::size_t chunk, std::size_t slot);
+
+    /// Number of threads to format with for a requested count; 0 requests one per hardware thread.
+    FORMATXX_PUBLIC unsigned FORMATXX_API batch_thread_count(unsigned requested) noexcept;
+
+    /// Format chunks on a set of threads while emitting them in order from the calling thread.
+    /// At most slot_count chunks are formatted ahead of the last one emitted.
+    FORMATXX_PUBLIC void FORMATXX_API run_batch(std::size_t chunk_count, std::size_t slot_count, unsigned threads, void* context, batch_thunk format_chunk, batch_thunk emit_chunk);
+}
+
+/// Options for format_batch.
+struct formatxx::format_batch_options {
+    /// threads formatting records, including the caller; 0 for one per hardware thread
+    unsigned threads = 0;
+    /// records formatted together by one thread into one buffer
+    std::size_t chunk_size = 512;
+    /// chunks each thread may format ahead of the output
+    std::size_t chunks_ahead = 4;
+};
+
+/// Output of one chunk, waiting to be written in order.
+template <typename CharT>
+struct formatxx::_detail::batch_slot {
+    std::vector<CharT> text;
+    result_code result = result_code::success;
+};
+
+template <typename CharT, typename IteratorT>
+struct formatxx::_detail::batch_context {
+    basic_string_view<CharT> format;
+    IteratorT first;
+    std::size_t count = 0;
+    std::size_t chunk_size = 0;
+    batch_slot<CharT>* slots = nullptr;
+    basic_format_writer<CharT>* writer = nullptr;
+    result_code result = result_code::success;
+
+    static void FORMATXX_API format_chunk(void* context, std::size_t chunk, std::size_t slot_index) {
+        batch_context& self = *static_cast<batch_context*>(context);
+        batch_slot<CharT>& slot = self.slots[slot_index];
+
+        slot.text.clear();
+        slot.result = result_code::success;
+
+        container_writer<std::vector<CharT>> out(slot.text);
+
+        std::size_t const begin = chunk * self.chunk_size;
+        std::size_t const end = begin + self.chunk_size < self.count ? begin + self.chunk_size : self.count;
+        for (std::size_t index = begin; index != end; ++index) {
+            result_code const result = std::apply([&self, &out](auto const& ... args) {
+                return format_impl(out, self.format, { make_format_arg<CharT, std::remove_cv_t<formattable_t<decltype(args)>>>(args)... });
+            }, *std::next(self.first, static_cast<typename std::iterator_traits<IteratorT>::difference_type>(index)));
+
+            if (result != result_code::success && slot.result == result_code::success) {
+                slot.result = result;
+            }
+        }
+    }
+
+    static void FORMATXX_API emit_chunk(void* context, std::size_t, std::size_t slot_index) {
+        batch_context& self = *static_cast<batch_context*>(context);
+        batch_slot<CharT> const& slot = self.slots[slot_index];
+
+        if (!slot.text.empty()) {
+            self.writer->write({ slot.text.data(), slot.text.size() });
+        }
+        if (slot.result != result_code::success && self.result == result_code::success) {
+            self.result = slot.result;
+        }
+    }
+};
+
+/// Format many records with the same format string, in parallel, into one writer.
+///
+/// The records are split into chunks of options.chunk_size; worker threads and the caller
+/// format chunks into private buffers, claiming the next chunk from a shared counter so that
+/// faster threads take on more of the work, while the caller writes finished chunks to the
+/// writer in the original order. Only the calling thread touches the writer, and only a
+/// bounded number of chunks are buffered at once.
+///
+/// Each record is a tuple-like value (std::tuple, std::pair, std::array) whose elements are
+/// the arguments for one formatting of the format string; include any separator such as a
+/// newline in the format string. The range must have random access iterators. Custom
+/// format_value overloads are called concurrently from several threads. If formatting or
+/// writing throws, the batch stops and the first exception is rethrown on the calling
+/// thread once every worker has finished.
+///
+/// @param writer The write buffer that will receive the formatted text.
+/// @param format The primary text and formatting controls, applied to each record.
+/// @param records The argument tuples to format.
+/// @returns the first error reported while formatting any record.
+template <typename CharT, typename FormatT, typename RangeT>
+formatxx::result_code formatxx::format_batch(basic_format_writer<CharT>& writer, FormatT const& format, RangeT const& records, format_batch_options const& options) {
+    using iterator = decltype(std::begin(records));
+
+    _detail::batch_context<CharT, iterator> context;
+    context.format = basic_string_view<CharT>(format);
+    context.first = std::begin(records);
+    context.count = static_cast<std::size_t>(std::distance(context.first, std::end(records)));
+    context.chunk_size = options.chunk_size != 0 ? options.chunk_size : 1;
+    context.writer = &writer;
+
+    std::size_t const chunk_count = (context.count + context.chunk_size - 1) / context.chunk_size;
+    if (chunk_count == 0) {
+        return result_code::success;
+    }
+
+    unsigned threads = _detail::batch_thread_count(options.threads);
+    if (threads > chunk_count) {
+        threads = static_cast<unsigned>(chunk_count);
+    }
+
+    std::size_t slot_count = threads > 1 ? threads * (options.chunks_ahead != 0 ? options.chunks_ahead : 1) : 1;
+    if (slot_count > chunk_count) {
+        slot_count = chunk_count;
+    }
+
+    std::vector<_detail::batch_slot<CharT>> slots(slot_count);
+    context.slots = slots.data();
+
+    _detail::run_batch(chunk_count, slot_count, threads, &context, &context.format_chunk, &context.emit_chunk);
+    return context.result;
+}
+
+#endif // !defined(_guard_FORMATXX_FORMAT_BATCH_H)
@@ -0,0 +1,320 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_FORMAT_RECORD_H)
+#define _guard_FORMATXX_FORMAT_RECORD_H
+#pragma once
+
+#include "formatxx/format.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace formatxx {
+    /// Opt a custom type into capture by copying its bytes; it must be trivially copyable
+    /// and have a format_value overload. Enums and pointers with a format_value overload
+    /// must opt in too, as they are otherwise captured as plain numbers and addresses.
+    template <typename T> struct capture_by_copy : std::false_type {};
+
+    /// Alignment required of buffers records are captured into.
+    constexpr std::size_t record_alignment = alignof(std::max_align_t);
+    /// Most arguments a single record may capture.
+    constexpr std::size_t max_record_args = 32;
+
+    template <typename CharT = char, typename FormatT, typename... Args>
+    std::size_t capture_format(void* buffer, std::size_t capacity, FormatT const& format, Args const& ... args) noexcept;
+    template <typename CharT = char, typename FormatT, typename... Args>
+    std::size_t capture_printf(void* buffer, std::size_t capacity, FormatT const& format, Args const& ... args) noexcept;
+
+    template <typename CharT>
+    result_code format_record(basic_format_writer<CharT>& writer, void const* record);
+
+    inline std::size_t record_size(void const* record) noexcept;
+}
+
+namespace formatxx::_detail {
+    enum class record_style : std::uint8_t {
+        format,
+        printf
+    };
+
+    /// Start of every captured record.
+    struct record_header {
+        /// the format string, which is referenced rather than copied
+        void const* format;
+        std::size_t format_size;
+        std::uint32_t size;
+        std::uint16_t arg_count;
+        std::uint8_t char_size;
+        record_style style;
+    };
+
+    /// Location and type of one captured argument. For custom types the formatting thunk
+    /// is stored immediately before the value.
+    struct record_arg {
+        std::uint32_t offset;
+        format_arg_type type;
+    };
+
+    template <typename T, typename CharT, typename = void>
+    struct string_char_of { using type = void; };
+    template <typename T, typename CharT>
+    struct string_char_of<T, CharT, std::void_t<decltype(std::declval<T const&>().data()), decltype(std::declval<T const&>().size())>> {
+        using type = std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<T const&>().data())>>;
+    };
+
+    /// Strings, string views, and other contiguous ranges of char or wchar_t are copied as text.
+    template <typename T, typename CharT>
+    constexpr bool is_capturable_string_v = std::is_same_v<typename string_char_of<T, CharT>::type, char> || std::is_same_v<typename string_char_of<T, CharT>::type, wchar_t>;
+
+    template <typename CharT>
+    class record_builder {
+    public:
+        record_builder(void* buffer, std::size_t capacity) noexcept : _buffer(static_cast<unsigned char*>(buffer)), _capacity(capacity) {}
+
+        bool begin(basic_string_view<CharT> format, std::size_t arg_count, record_style style) noexcept {
+            _header = static_cast<record_header*>(_allocate(sizeof(record_header), alignof(record_header)));
+            _args = static_cast<record_arg*>(_allocate(sizeof(record_arg) * arg_count, alignof(record_arg)));
+            if (_header == nullptr || _args == nullptr) {
+                return false;
+            }
+
+            _header->format = format.data();
+            _header->format_size = format.size();
+            _header->arg_count = static_cast<std::uint16_t>(arg_count);
+            _header->char_size = static_cast<std::uint8_t>(sizeof(CharT));
+            _header->style = style;
+            return true;
+        }
+
+        template <typename T>
+        void add(T const& value) noexcept;
+
+        std::size_t finish() noexcept {
+            if (_overflow) {
+                return 0;
+            }
+            _header->size = static_cast<std::uint32_t>(_size);
+            return _size;
+        }
+
+    private:
+        void* _allocate(std::size_t size, std::size_t alignment) noexcept {
+            std::size_t const offset = (_size + alignment - 1) & ~(alignment - 1);
+            if (_overflow || offset > _capacity || size > _capacity - offset) {
+                _overflow = true;
+                return nullptr;
+            }
+            _size = offset + size;
+            return _buffer + offset;
+        }
+
+        void _set(format_arg_type type, void const* payload) noexcept {
+            record_arg& arg = _args[_index++];
+            arg.type = type;
+            arg.offset = payload != nullptr ? static_cast<std::uint32_t>(static_cast<unsigned char const*>(payload) - _buffer) : 0;
+        }
+
+        template <typename T>
+        void _copy(format_arg_type type, T const& value) noexcept {
+            void* const payload = _allocate(sizeof(T), alignof(T));
+            if (payload != nullptr) {
+                std::memcpy(payload, &value, sizeof(T));
+            }
+            _set(type, payload);
+        }
+
+        template <typename StringCharT>
+        void _copy_string(StringCharT const* data, std::size_t length) noexcept {
+            auto* const payload = static_cast<StringCharT*>(_allocate(sizeof(StringCharT) * (length + 1), alignof(StringCharT)));
+            if (payload != nullptr) {
+                if (length != 0) {
+                    std::memcpy(payload, data, sizeof(StringCharT) * length);
+                }
+                payload[length] = StringCharT{};
+            }
+            _set(std::is_same_v<StringCharT, char> ? format_arg_type::char_string : format_arg_type::wchar_string, payload);
+        }
+
+        unsigned char* _buffer = nullptr;
+        std::size_t _capacity = 0;
+        std::size_t _size = 0;
+        record_header* _header = nullptr;
+        record_arg* _args = nullptr;
+        std::size_t _index = 0;
+        bool _overflow = false;
+    };
+
+    template <typename CharT, typename FormatT, typename... Args>
+    std::size_t capture_record(void* buffer, std::size_t capacity, record_style style, FormatT const& format, Args const& ... args) noexcept {
+        static_assert(sizeof...(Args) <= max_record_args, "too many arguments to capture in a record");
+
+        record_builder<CharT> builder(buffer, capacity);
+        if (!builder.begin(basic_string_view<CharT>(format), sizeof...(Args), style)) {
+            return 0;
+        }
+        (builder.add(static_cast<formattable_t<Args> const&>(args)), ...);
+        return builder.finish();
+    }
+}
+
+template <typename CharT>
+template <typename T>
+void formatxx::_detail::record_builder<CharT>::add(T const& value) noexcept {
+    constexpr format_arg_type type = type_of<T>::value;
+
+    if constexpr (type == format_arg_type::char_string || type == format_arg_type::wchar_string) {
+        using string_char = std::remove_cv_t<std::remove_pointer_t<T>>;
+        std::size_t length = 0;
+        if (value != nullptr) {
+            while (value[length] != string_char{}) {
+                ++length;
+            }
+        }
+        _copy_string(value, length);
+    }
+    else if constexpr (type == format_arg_type::null_pointer) {
+        _set(type, nullptr);
+    }
+    else if constexpr (type != format_arg_type::unknown) {
+        _copy(type, value);
+    }
+    else if constexpr (is_capturable_string_v<T, CharT>) {
+        _copy_string(value.data(), value.size());
+    }
+    else if constexpr (capture_by_copy<T>::value) {
+        static_assert(std::is_trivially_copyable_v<T>, "capture_by_copy requires a trivially copyable type");
+        static_assert(alignof(T) <= record_alignment, "capture_by_copy type is over-aligned");
+        static_assert(has_format_value<CharT, T>::value, "capture_by_copy requires a format_value overload");
+
+        using thunk_type = typename basic_format_arg<CharT>::thunk_type;
+        constexpr std::size_t alignment = alignof(T) > alignof(thunk_type) ? alignof(T) : alignof(thunk_type);
+        constexpr std::size_t prefix = (sizeof(thunk_type) + alignment - 1) & ~(alignment - 1);
+
+        auto* const block = static_cast<unsigned char*>(_allocate(prefix + sizeof(T), alignment));
+        if (block == nullptr) {
+            _set(format_arg_type::custom, nullptr);
+            return;
+        }
+
+        thunk_type const thunk = &format_value_thunk<CharT, T>;
+        std::memcpy(block + prefix - sizeof(thunk_type), &thunk, sizeof(thunk_type));
+        std::memcpy(block + prefix, &value, sizeof(T));
+        _set(format_arg_type::custom, block + prefix);
+    }
+    else if constexpr (has_format_value<CharT, T>::value) {
+        // enums and pointers included; capturing them as numbers would bypass the overload
+        static_assert(capture_by_copy<T>::value, "type with a format_value overload cannot be captured; specialize formatxx::capture_by_copy for trivially copyable types");
+    }
+    else if constexpr (std::is_pointer_v<T>) {
+        _copy(format_arg_type::void_pointer, static_cast<void const*>(value));
+    }
+    else if constexpr (std::is_enum_v<T>) {
+        _copy(type_of<std::underlying_type_t<T>>::value, static_cast<std::underlying_type_t<T>>(value));
+    }
+    else {
+        static_assert(capture_by_copy<T>::value, "type cannot be captured; specialize formatxx::capture_by_copy for trivially copyable types");
+    }
+}
+
+/// Capture a format string and its arguments into a self-contained record, to be
+/// rendered later by format_record. Arguments are copied, including strings; the format
+/// string itself is referenced and must outlive the record.
+/// @param buffer Storage for the record, aligned to record_alignment.
+/// @param capacity Size of buffer in bytes.
+/// @returns the size of the record, or 0 if it does not fit.
+template <typename CharT, typename FormatT, typename... Args>
+std::size_t formatxx::capture_format(void* buffer, std::size_t capacity, FormatT const& format, Args const& ... args) noexcept {
+    return _detail::capture_record<CharT>(buffer, capacity, _detail::record_style::format, format, args...);
+}
+
+/// Capture a printf format string and its arguments into a self-contained record.
+/// @see capture_format
+template <typename CharT, typename FormatT, typename... Args>
+std::size_t formatxx::capture_printf(void* buffer, std::size_t capacity, FormatT const& format, Args const& ... args) noexcept {
+    return _detail::capture_record<CharT>(buffer, capacity, _detail::record_style::printf, format, args...);
+}
+
+/// Render a record produced by capture_format or capture_printf.
+/// @param writer The write buffer that will receive the formatted text.
+/// @param record The captured record.
+/// @returns a result code indicating any errors.
+template <typename CharT>
+formatxx::result_code formatxx::format_record(basic_format_writer<CharT>& writer, void const* record) {
+    using arg_type = _detail::basic_format_arg<CharT>;
+    using thunk_type = typename arg_type::thunk_type;
+
+    auto const* const bytes = static_cast<unsigned char const*>(record);
+    auto const& header = *static_cast<_detail::record_header const*>(record);
+    if (header.char_size != sizeof(CharT) || header.arg_count > max_record_args) {
+        return result_code::malformed_input;
+    }
+
+    auto const* const captured = reinterpret_cast<_detail::record_arg const*>(bytes + ((sizeof(_detail::record_header) + alignof(_detail::record_arg) - 1) & ~(alignof(_detail::record_arg) - 1)));
+
+    arg_type args[max_record_args];
+    void const* strings[max_record_args];
+    for (std::size_t index = 0; index != header.arg_count; ++index) {
+        _detail::format_arg_type const type = captured[index].type;
+        void const* const payload = bytes + captured[index].offset;
+
+        switch (type) {
+        case _detail::format_arg_type::char_string:
+        case _detail::format_arg_type::wchar_string:
+            strings[index] = payload;
+            args[index] = arg_type(type, &strings[index]);
+            break;
+        case _detail::format_arg_type::null_pointer:
+            args[index] = arg_type(type, nullptr);
+            break;
+        case _detail::format_arg_type::custom: {
+            thunk_type thunk;
+            std::memcpy(&thunk, static_cast<unsigned char const*>(payload) - sizeof(thunk_type), sizeof(thunk_type));
+            args[index] = arg_type(thunk, payload);
+            break;
+        }
+        default:
+            args[index] = arg_type(type, payload);
+            break;
+        }
+    }
+
+    basic_string_view<CharT> const format(static_cast<CharT const*>(header.format), header.format_size);
+    _detail::basic_format_arg_list<CharT> const list(args, header.arg_count);
+    return header.style == _detail::record_style::printf ? _detail::printf_impl(writer, format, list) : _detail::format_impl(writer, format, list);
+}
+
+/// Size in bytes of a captured record.
+inline std::size_t formatxx::record_size(void const* record) noexcept {
+    return static_cast<_detail::record_header const*>(record)->size;
+}
+
+#endif // !defined(_guard_FORMATXX_FORMAT_RECORD_H)
@@ -0,0 +1,126 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_FORMAT_SESSION_H)
+#define _guard_FORMATXX_FORMAT_SESSION_H
+#pragma once
+
+#include "formatxx/format.h"
+#include <cstddef>
+#include <tuple>
+
+namespace formatxx {
+    template <typename CharT, typename... Args> class basic_format_session;
+
+    template <typename CharT = char, typename FormatT, typename... Args>
+    constexpr basic_format_session<CharT, _detail::formattable_t<Args>...> format_session(FormatT const& format, Args const& ... args) noexcept;
+}
+
+namespace formatxx::_detail {
+    template <typename CharT> class format_session_state;
+}
+
+/// Progress of a resumable formatting operation, independent of the argument types.
+template <typename CharT>
+class formatxx::_detail::format_session_state {
+public:
+    constexpr explicit format_session_state(basic_string_view<CharT> format) noexcept : _cursor(format.data()), _end(format.data() + format.size()) {}
+
+    FORMATXX_PUBLIC result_code FORMATXX_API resume(CharT* buffer, std::size_t capacity, basic_format_arg_list<CharT> args);
+
+    constexpr bool done() const noexcept { return _cursor == _end; }
+    constexpr std::size_t size() const noexcept { return _size; }
+    constexpr result_code result() const noexcept { return _result; }
+
+private:
+    CharT const* _cursor = nullptr;
+    CharT const* _end = nullptr;
+    std::size_t _skip = 0;
+    std::size_t _size = 0;
+    unsigned _next_index = 0;
+    result_code _result = result_code::success;
+};
+
+extern template FORMATXX_PUBLIC formatxx::result_code FORMATXX_API formatxx::_detail::format_session_state<char>::resume(char* buffer, std::size_t capacity, basic_format_arg_list<char> args);
+extern template FORMATXX_PUBLIC formatxx::result_code FORMATXX_API formatxx::_detail::format_session_state<wchar_t>::resume(wchar_t* buffer, std::size_t capacity, basic_format_arg_list<wchar_t> args);
+
+/// A formatting operation that streams its output through a series of fixed-size buffers.
+///
+/// Each call to resume() fills the given buffer with the next part of the message and
+/// pauses with result_code::out_of_space when it is full, so a message of any length can
+/// be passed through a small socket or DMA window without allocating or truncating. The
+/// session remembers its position in the format string and how much of the current
+/// replacement field was already emitted; a field split across buffers is formatted
+/// again and the emitted prefix skipped. Scalar arguments are copied; others are held
+/// by reference and must outlive the session.
+template <typename CharT, typename... Args>
+class formatxx::basic_format_session {
+public:
+    constexpr basic_format_session(basic_string_view<CharT> format, _detail::stored_arg_t<Args>... args) noexcept : _state(format), _args(args...) {}
+
+    /// Write the next part of the message.
+    /// @param buffer Receives the output; it is not NUL-terminated.
+    /// @param capacity Number of characters available in buffer.
+    /// @returns out_of_space if more of the message remains, otherwise the result of the
+    ///     whole formatting operation.
+    result_code resume(CharT* buffer, std::size_t capacity) {
+        return std::apply([this, buffer, capacity](auto const& ... args) {
+            return _state.resume(buffer, capacity, { _detail::make_format_arg<CharT, Args>(args)... });
+        }, _args);
+    }
+
+    template <std::size_t Capacity>
+    result_code resume(CharT(&buffer)[Capacity]) { return resume(buffer, Capacity); }
+
+    /// True once the whole message has been written.
+    constexpr bool done() const noexcept { return _state.done(); }
+
+    /// Number of characters written to the buffer by the last call to resume().
+    constexpr std::size_t size() const noexcept { return _state.size(); }
+
+    /// Errors in the format string or arguments seen so far.
+    constexpr result_code result() const noexcept { return _state.result(); }
+
+private:
+    _detail::format_session_state<CharT> _state;
+    std::tuple<_detail::stored_arg_t<Args>...> _args;
+};
+
+/// Start a resumable formatting operation.
+/// @param format The primary text and formatting controls; referenced, not copied.
+/// @param args The arguments; scalars are copied, others held by reference.
+/// @returns a session writing the message through resume().
+template <typename CharT, typename FormatT, typename... Args>
+constexpr formatxx::basic_format_session<CharT, formatxx::_detail::formattable_t<Args>...> formatxx::format_session(FormatT const& format, Args const& ... args) noexcept {
+    return { basic_string_view<CharT>(format), args... };
+}
+
+#endif // !defined(_guard_FORMATXX_FORMAT_SESSION_H)
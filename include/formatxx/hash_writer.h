@@ -0,0 +1,98 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_HASH_WRITER_H)
+#define _guard_FORMATXX_HASH_WRITER_H
+#pragma once
+
+#include "formatxx/format.h"
+#include <cstdint>
+
+namespace formatxx {
+    template <typename CharT> class basic_hash_writer;
+
+    using hash_writer = basic_hash_writer<char>;
+    using whash_writer = basic_hash_writer<wchar_t>;
+
+    template <typename CharT = char, typename FormatT, typename... Args> std::uint64_t format_hash(FormatT const& format, Args const& ... args);
+}
+
+namespace formatxx::_detail {
+    /// Streaming XXH64 state.
+    struct xxh64_state {
+        std::uint64_t total = 0;
+        std::uint64_t lanes[4] = {};
+        unsigned char pending[32] = {};
+        unsigned pending_size = 0;
+    };
+
+    FORMATXX_PUBLIC void FORMATXX_API xxh64_reset(xxh64_state& state, std::uint64_t seed) noexcept;
+    FORMATXX_PUBLIC void FORMATXX_API xxh64_update(xxh64_state& state, void const* data, std::size_t size) noexcept;
+    FORMATXX_PUBLIC std::uint64_t FORMATXX_API xxh64_digest(xxh64_state const& state) noexcept;
+}
+
+/// Writer that hashes output as it is produced, without storing the text.
+///
+/// The digest is the XXH64 hash of the characters' bytes, identical to hashing the fully
+/// formatted text in one call. Output may also be forwarded to another writer.
+template <typename CharT>
+class formatxx::basic_hash_writer final : public formatxx::basic_format_writer<CharT> {
+public:
+    explicit basic_hash_writer(std::uint64_t seed = 0) noexcept { reset(seed); }
+    /// Hash output while also forwarding it to next.
+    explicit basic_hash_writer(basic_format_writer<CharT>& next, std::uint64_t seed = 0) noexcept : _next(&next) { reset(seed); }
+
+    void write(basic_string_view<CharT> str) override {
+        _detail::xxh64_update(_state, str.data(), str.size() * sizeof(CharT));
+        if (_next != nullptr) {
+            _next->write(str);
+        }
+    }
+
+    /// Hash of everything written since construction or the last reset().
+    std::uint64_t digest() const noexcept { return _detail::xxh64_digest(_state); }
+
+    void reset(std::uint64_t seed = 0) noexcept { _detail::xxh64_reset(_state, seed); }
+
+private:
+    _detail::xxh64_state _state;
+    basic_format_writer<CharT>* _next = nullptr;
+};
+
+/// Hash formatted output without materializing it.
+/// @returns the XXH64 hash of the formatted text.
+template <typename CharT, typename FormatT, typename... Args>
+std::uint64_t formatxx::format_hash(FormatT const& format, Args const& ... args) {
+    basic_hash_writer<CharT> writer;
+    format_to(writer, format, args...);
+    return writer.digest();
+}
+
+#endif // !defined(_guard_FORMATXX_HASH_WRITER_H)
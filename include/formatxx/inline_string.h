@@ -0,0 +1,98 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_INLINE_STRING_H)
+#define _guard_FORMATXX_INLINE_STRING_H
+#pragma once
+
+#include <litexx/string_view.h>
+#include <cstring>
+
+namespace formatxx {
+    template <typename CharT, std::size_t Capacity> class inline_string;
+} // namespace formatxx
+
+/// A string with fixed inline storage that truncates instead of allocating.
+///
+/// Suitable as a format_as result in code where allocation is forbidden; check
+/// truncated() to learn whether the output was cut short.
+template <typename CharT, std::size_t Capacity>
+class formatxx::inline_string {
+public:
+    using value_type = CharT;
+    using size_type = std::size_t;
+    using pointer = value_type*;
+    using const_pointer = value_type const*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+
+    inline_string() noexcept { _buffer[0] = CharT(0); }
+
+    void append(value_type const* data, size_type length) noexcept;
+
+    constexpr bool empty() const noexcept { return _size == 0; }
+    constexpr bool truncated() const noexcept { return _truncated; }
+    constexpr size_type size() const noexcept { return _size; }
+    static constexpr size_type capacity() noexcept { return Capacity; }
+
+    void clear() noexcept { _size = 0; _truncated = false; _buffer[0] = CharT(0); }
+
+    pointer data() noexcept { return _buffer; }
+    const_pointer data() const noexcept { return _buffer; }
+    const_pointer c_str() const noexcept { return _buffer; }
+
+    iterator begin() noexcept { return _buffer; }
+    iterator end() noexcept { return _buffer + _size; }
+
+    const_iterator begin() const noexcept { return _buffer; }
+    const_iterator end() const noexcept { return _buffer + _size; }
+
+    operator litexx::basic_string_view<value_type>() const noexcept { return { _buffer, _size }; }
+
+private:
+    size_type _size = 0;
+    bool _truncated = false;
+    CharT _buffer[Capacity + 1/*NUL*/];
+};
+
+template <typename CharT, std::size_t Capacity>
+void formatxx::inline_string<CharT, Capacity>::append(value_type const* data, size_type length) noexcept {
+    size_type const available = Capacity - _size;
+    if (length > available) {
+        length = available;
+        _truncated = true;
+    }
+
+    std::memcpy(_buffer + _size, data, sizeof(CharT) * length);
+    _size += length;
+    _buffer[_size] = CharT(0);
+}
+
+#endif // !defined(_guard_FORMATXX_INLINE_STRING_H)
@@ -0,0 +1,116 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_LAZY_H)
+#define _guard_FORMATXX_LAZY_H
+#pragma once
+
+#include "formatxx/format.h"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace formatxx {
+    template <typename CharT, typename... Args> class basic_lazy_format;
+
+    template <typename CharT = char, typename FormatT, typename... Args>
+    constexpr basic_lazy_format<CharT, _detail::formattable_t<Args>...> lazy(FormatT const& format, Args const& ... args) noexcept;
+
+    template <typename CharT, typename... Args>
+    result_code format_value(basic_format_writer<CharT>& out, basic_lazy_format<CharT, Args...> const& value, basic_format_options<CharT> const& options = {});
+}
+
+namespace formatxx::_detail {
+    /// Callables taking no arguments are invoked, and their result formatted, unless they
+    /// have their own format_value overload.
+    template <typename CharT, typename T>
+    constexpr bool is_lazy_callable_v = type_of<T>::value == format_arg_type::unknown && !has_format_value<CharT, T>::value && std::is_invocable_v<T const&>;
+
+    template <typename CharT, typename F>
+    result_code FORMATXX_API invoke_thunk(basic_format_writer<CharT>& out, void const* ptr, basic_format_options<CharT> options) {
+        auto const& result = (*static_cast<F const*>(ptr))();
+        using result_type = std::remove_cv_t<formattable_t<decltype(result)>>;
+        result_type const& value = result;
+        return make_format_arg<CharT, result_type>(value).format_into(out, options);
+    }
+
+    template <typename CharT, typename T>
+    constexpr basic_format_arg<CharT> make_lazy_arg(T const& value) noexcept {
+        if constexpr (is_lazy_callable_v<CharT, T>) {
+            return basic_format_arg<CharT>(&invoke_thunk<CharT, T>, &value);
+        }
+        else {
+            return make_format_arg<CharT, T>(value);
+        }
+    }
+}
+
+/// A format string and references to its arguments, formatted only when written.
+///
+/// Created by lazy(). Formatting a lazy object through format_value renders its message,
+/// evaluating any callable arguments at that moment; if it is never written, neither the
+/// formatting nor the callables cost anything. Scalar arguments are copied; others are
+/// held by reference and must outlive the object.
+template <typename CharT, typename... Args>
+class formatxx::basic_lazy_format {
+public:
+    constexpr basic_lazy_format(basic_string_view<CharT> format, _detail::stored_arg_t<Args>... args) noexcept : _format(format), _args(args...) {}
+
+    /// Render the message into a writer.
+    result_code format_to(basic_format_writer<CharT>& writer) const {
+        return std::apply([this, &writer](auto const& ... args) {
+            return _detail::format_impl(writer, _format, { _detail::make_lazy_arg<CharT, Args>(args)... });
+        }, _args);
+    }
+
+private:
+    basic_string_view<CharT> _format;
+    std::tuple<_detail::stored_arg_t<Args>...> _args;
+};
+
+/// Capture a format string and its arguments for formatting later.
+/// @param format The primary text and formatting controls; referenced, not copied.
+/// @param args The arguments; scalars are copied, others held by reference. Callables
+///     taking no arguments are invoked when the message is formatted.
+/// @returns a formattable object rendering the message.
+template <typename CharT, typename FormatT, typename... Args>
+constexpr formatxx::basic_lazy_format<CharT, formatxx::_detail::formattable_t<Args>...> formatxx::lazy(FormatT const& format, Args const& ... args) noexcept {
+    return { basic_string_view<CharT>(format), args... };
+}
+
+/// Render a lazy message. Its own format string controls the formatting, so the options
+/// of the enclosing field (width, alignment, and so on) are ignored; honouring them would
+/// mean buffering the whole message to measure it.
+template <typename CharT, typename... Args>
+formatxx::result_code formatxx::format_value(basic_format_writer<CharT>& out, basic_lazy_format<CharT, Args...> const& value, basic_format_options<CharT> const&) {
+    return value.format_to(out);
+}
+
+#endif // !defined(_guard_FORMATXX_LAZY_H)
@@ -0,0 +1,142 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_MAPPED_WRITER_H)
+#define _guard_FORMATXX_MAPPED_WRITER_H
+#pragma once
+
+#include "formatxx/writers.h"
+#include <cstdint>
+
+namespace formatxx {
+    class mapped_file_writer;
+
+    struct mapped_writer_options;
+    enum class mapped_sync : unsigned char;
+}
+
+/// How a mapped window is flushed to storage when the writer moves past it.
+enum class formatxx::mapped_sync : unsigned char {
+    /// leave write-back to the operating system
+    none,
+    /// schedule write-back without waiting (msync MS_ASYNC)
+    async,
+    /// wait for write-back to complete (msync MS_SYNC)
+    sync
+};
+
+/// Options for mapped_file_writer.
+struct formatxx::mapped_writer_options {
+    /// size of each mapped region; rounded up to a multiple of the page size
+    std::size_t window_size = 1 << 20;
+    /// start a new file (path.1, path.2, ...) once a file would exceed this size; 0 for never
+    std::uint64_t max_file_size = 0;
+    mapped_sync sync = mapped_sync::none;
+    /// advise the kernel that each window is written sequentially
+    bool sequential = true;
+};
+
+/// Writer that formats directly into a memory-mapped window of a log file.
+///
+/// When the window fills, the file is extended and the next window mapped, or the
+/// writer rolls over to a new file once max_file_size is reached. Disk space for each
+/// window is reserved before it is mapped where the platform supports it, so a full disk
+/// fails with result_code::out_of_space instead of faulting. Closing the writer truncates
+/// the file to the bytes actually written.
+///
+/// The file at path, and each rolled file (path.1, path.2, ...) as the writer reaches it,
+/// is truncated when opened; existing contents are replaced, not appended to. Only
+/// supported on POSIX systems; elsewhere open() fails with result_code::io_error.
+class formatxx::mapped_file_writer final : public formatxx::format_writer {
+public:
+    static constexpr std::size_t max_path_length = 256;
+
+    mapped_file_writer() noexcept = default;
+    ~mapped_file_writer() { close(); }
+
+    mapped_file_writer(mapped_file_writer const&) = delete;
+    mapped_file_writer& operator=(mapped_file_writer const&) = delete;
+
+    FORMATXX_PUBLIC result_code FORMATXX_API open(char const* path, mapped_writer_options const& options = {}) noexcept;
+    FORMATXX_PUBLIC result_code FORMATXX_API close() noexcept;
+
+    void write(string_view str) override;
+
+    /// Synchronously flush the current window to storage.
+    FORMATXX_PUBLIC result_code FORMATXX_API sync() noexcept;
+
+    bool is_open() const noexcept { return _fd != -1; }
+    result_code result() const noexcept { return _result; }
+
+    /// Number of times the writer has rolled over to a new file.
+    unsigned file_index() const noexcept { return _file_index; }
+    /// Bytes written to the current file.
+    std::uint64_t size() const noexcept { return _window_offset + static_cast<std::uint64_t>(_cursor - _window); }
+
+private:
+    FORMATXX_PUBLIC result_code FORMATXX_API _advance() noexcept;
+    result_code _map(std::uint64_t offset) noexcept;
+    result_code _unmap() noexcept;
+    result_code _open_file() noexcept;
+    result_code _close_file() noexcept;
+    void _fail(result_code result) noexcept;
+
+    char* _window = nullptr;
+    char* _cursor = nullptr;
+    char* _end = nullptr;
+    std::uint64_t _window_offset = 0;
+    mapped_writer_options _options;
+    int _fd = -1;
+    unsigned _file_index = 0;
+    result_code _result = result_code::success;
+    char _path[max_path_length] = {};
+};
+
+inline void formatxx::mapped_file_writer::write(string_view str) {
+    if (_window == nullptr) {
+        return;
+    }
+
+    for (;;) {
+        std::size_t const copied = _detail::copy_clamped(_cursor, _end, str);
+        _cursor += copied;
+
+        if (copied == str.size()) {
+            return;
+        }
+
+        str = string_view(str.data() + copied, str.size() - copied);
+        if (_advance() != result_code::success) {
+            return;
+        }
+    }
+}
+
+#endif // !defined(_guard_FORMATXX_MAPPED_WRITER_H)
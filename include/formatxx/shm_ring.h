@@ -0,0 +1,248 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#if !defined(_guard_FORMATXX_SHM_RING_H)
+#define _guard_FORMATXX_SHM_RING_H
+#pragma once
+
+#include "formatxx/format.h"
+#include "formatxx/inline_string.h"
+#include "formatxx/_detail/stage_record.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace formatxx {
+    class shm_ring;
+    class shm_ring_writer;
+    class shm_ring_producer;
+    class shm_ring_reader;
+}
+
+namespace formatxx::_detail {
+    struct shm_ring_header;
+    struct shm_record_header;
+}
+
+/// Control block at the start of a shared-memory ring. Every field is address-free so the
+/// ring may be mapped at different addresses in each process.
+struct formatxx::_detail::shm_ring_header {
+    static constexpr std::uint32_t magic_value = 0x52584d46; // "FMXR"
+    static constexpr std::uint32_t version_value = 1;
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t capacity = 0;
+
+    /// producers' reservation cursor, in bytes since creation
+    alignas(64) std::atomic<std::uint64_t> write = 0;
+    /// consumer cursor; everything before it is zeroed and free for reuse
+    alignas(64) std::atomic<std::uint64_t> read = 0;
+    /// records producers could not fit
+    alignas(64) std::atomic<std::uint64_t> dropped = 0;
+};
+
+/// Prefix of every record in the ring, 8-byte aligned.
+struct formatxx::_detail::shm_record_header {
+    static constexpr std::uint32_t empty = 0;
+    static constexpr std::uint32_t record = 1;
+    static constexpr std::uint32_t padding = 2;
+
+    /// set last, with release semantics, once the record is complete
+    std::atomic<std::uint32_t> state;
+    std::uint32_t size;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+    "shared-memory rings require address-free atomics");
+static_assert(sizeof(formatxx::_detail::shm_record_header) == 8);
+
+/// A ring of text records in POSIX shared memory (shm_open and mmap).
+///
+/// One process creates the ring; producers and the consumer open it by name. Records are
+/// published without system calls: producers reserve space with atomics on the shared
+/// cursors, and the consumer polls for completed records. Only supported on POSIX systems;
+/// elsewhere create() and open() fail with result_code::io_error.
+class formatxx::shm_ring {
+public:
+    shm_ring() noexcept = default;
+    ~shm_ring() { close(); }
+
+    shm_ring(shm_ring const&) = delete;
+    shm_ring& operator=(shm_ring const&) = delete;
+
+    /// Create (or replace) the named ring.
+    /// @param capacity Record space in bytes, rounded up to a power of two.
+    FORMATXX_PUBLIC result_code FORMATXX_API create(char const* name, std::size_t capacity) noexcept;
+    /// Map an existing named ring.
+    FORMATXX_PUBLIC result_code FORMATXX_API open(char const* name) noexcept;
+    FORMATXX_PUBLIC void FORMATXX_API close() noexcept;
+
+    /// Remove the name; processes with the ring mapped keep using it.
+    FORMATXX_PUBLIC static result_code FORMATXX_API unlink(char const* name) noexcept;
+
+    bool is_open() const noexcept { return _header != nullptr; }
+    std::size_t capacity() const noexcept { return _header != nullptr ? static_cast<std::size_t>(_header->capacity) : 0; }
+    /// Records producers have dropped for lack of space.
+    std::uint64_t dropped() const noexcept { return _header != nullptr ? _header->dropped.load(std::memory_order_relaxed) : 0; }
+
+    _detail::shm_ring_header* header() const noexcept { return _header; }
+    char* data() const noexcept { return _data; }
+
+private:
+    _detail::shm_ring_header* _header = nullptr;
+    char* _data = nullptr;
+    std::size_t _mapped_size = 0;
+};
+
+/// Writer that formats each record in place in a ring, for rings with a single producer.
+///
+/// Text written since the last commit() forms one record, which becomes visible to the
+/// consumer on commit(). A record that does not fit in the free space is dropped. Must not
+/// be combined with any other producer on the same ring.
+class formatxx::shm_ring_writer final : public formatxx::format_writer {
+public:
+    explicit shm_ring_writer(shm_ring& ring) noexcept : _ring(ring) {}
+    ~shm_ring_writer() { cancel(); }
+
+    void write(string_view str) override;
+
+    /// Publish the pending record.
+    FORMATXX_PUBLIC result_code FORMATXX_API commit() noexcept;
+    /// Discard the pending record.
+    void cancel() noexcept { _size = _pad = 0; _started = _overflow = false; }
+
+    /// Format a single record and publish it.
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args);
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args);
+
+private:
+    FORMATXX_PUBLIC void FORMATXX_API _reserve(string_view str) noexcept;
+
+    shm_ring& _ring;
+    std::uint64_t _start = 0;
+    std::uint64_t _limit = 0;
+    std::size_t _size = 0;
+    std::size_t _pad = 0;
+    bool _started = false;
+    bool _overflow = false;
+};
+
+/// Publishes records into a ring from any number of threads or processes.
+///
+/// Each record is formatted onto the stack, then copied into space reserved with a
+/// compare-and-swap on the shared cursor. Records longer than max_record_size are
+/// published truncated and format() or printf() returns result_code::out_of_space.
+class formatxx::shm_ring_producer {
+public:
+    static constexpr std::size_t max_record_size = 1024;
+
+    explicit shm_ring_producer(shm_ring& ring) noexcept : _ring(ring) {}
+
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args);
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args);
+
+    /// Publish text as a single record.
+    /// @returns result_code::out_of_space if the record was dropped.
+    FORMATXX_PUBLIC result_code FORMATXX_API publish(string_view text) noexcept;
+
+private:
+    shm_ring& _ring;
+};
+
+/// Consumes records from a ring; only one reader may consume a ring at a time.
+class formatxx::shm_ring_reader {
+public:
+    explicit shm_ring_reader(shm_ring& ring) noexcept : _ring(ring) {}
+
+    /// Invoke callback(string_view) for each completed record, in publication order,
+    /// then release their space to producers. The view is only valid during the call.
+    /// @param max_records Stop after this many records.
+    /// @returns the number of records consumed.
+    template <typename CallbackT> std::size_t poll(CallbackT&& callback, std::size_t max_records = ~std::size_t(0));
+
+private:
+    using visit_thunk = void(*)(void* context, string_view record);
+
+    FORMATXX_PUBLIC std::size_t FORMATXX_API _poll(visit_thunk thunk, void* context, std::size_t max_records) noexcept;
+
+    shm_ring& _ring;
+};
+
+inline void formatxx::shm_ring_writer::write(string_view str) {
+    if (_started && !_overflow) {
+        std::uint64_t const offset = (_start + _pad + sizeof(_detail::shm_record_header) + _size) & (_ring.header()->capacity - 1);
+        if (_start + _pad + sizeof(_detail::shm_record_header) + _size + str.size() <= _limit) {
+            std::memcpy(_ring.data() + offset, str.data(), str.size());
+            _size += str.size();
+            return;
+        }
+    }
+    _reserve(str);
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::shm_ring_writer::format(FormatT const& format, Args const& ... args) {
+    result_code const result = format_to(*this, format, args...);
+    result_code const committed = commit();
+    return committed != result_code::success ? committed : result;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::shm_ring_writer::printf(FormatT const& format, Args const& ... args) {
+    result_code const result = printf_to(*this, format, args...);
+    result_code const committed = commit();
+    return committed != result_code::success ? committed : result;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::shm_ring_producer::format(FormatT const& format, Args const& ... args) {
+    inline_string<char, max_record_size> staging;
+    result_code const result = _detail::stage_format(staging, format, args...);
+    result_code const published = publish(staging);
+    return published != result_code::success ? published : result;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::shm_ring_producer::printf(FormatT const& format, Args const& ... args) {
+    inline_string<char, max_record_size> staging;
+    result_code const result = _detail::stage_printf(staging, format, args...);
+    result_code const published = publish(staging);
+    return published != result_code::success ? published : result;
+}
+
+template <typename CallbackT>
+std::size_t formatxx::shm_ring_reader::poll(CallbackT&& callback, std::size_t max_records) {
+    using callback_type = std::remove_reference_t<CallbackT>;
+    return _poll([](void* context, string_view record) { (*static_cast<callback_type*>(context))(record); },
+        const_cast<void*>(static_cast<void const*>(&callback)), max_records);
+}
+
+#endif // !defined(_guard_FORMATXX_SHM_RING_H)
@@ -32,20 +32,11 @@
 #define _guard_FORMATXX_SMALL_STRING_H
 #pragma once
 
+#include "formatxx/allocation_tracking.h"
+#include "formatxx/_detail/new_delete_allocator.h"
 #include <litexx/string_view.h>
 #include <cstring>
 
-namespace formatxx::_detail {
-    template <typename T>
-    struct new_delete_allocator {
-        static_assert(std::is_trivial_v<T>);
-
-        T* allocate(std::size_t count) { return new T[count]; }
-        void deallocate(T* ptr, std::size_t) { delete[] ptr; }
-    };
-
-} // namespace formatxx::_detail
-
 namespace formatxx {
     template <typename CharT, std::size_t FixedCapacity, typename AllocatorT = _detail::new_delete_allocator<CharT>> class small_string;
 } // namespace formatxx
@@ -59,6 +50,9 @@ public:
     using pointer = value_type *;
     using iterator = pointer;
     using const_iterator = value_type const*;
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+    using tracks_allocations = void;
+#endif
 
     small_string() noexcept = default;
     ~small_string();
@@ -112,6 +106,7 @@ auto formatxx::small_string<CharT, FixedCapacity, AllocatorT>::_grow(std::size_t
     }
 
     value_type* tmp = this->allocate(new_capacity + 1/*NUL*/);
+    FORMATXX_TRACK_ALLOCATION(sizeof(CharT) * (new_capacity + 1/*NUL*/));
     std::memcpy(tmp, data(), sizeof(CharT) * _size + 1/*NUL*/);
 
     if (_data != nullptr) {
@@ -33,6 +33,8 @@
 #pragma once
 
 #include <formatxx/format.h>
+#include <formatxx/allocation_tracking.h>
+#include <cstring>
 #include <string>
 #include <string_view>
 
@@ -54,6 +56,250 @@ namespace formatxx {
     template <typename StringT = std::string, typename FormatT, typename... Args> StringT printf_string(FormatT const& format, Args const& ... args) {
         return printf_as<StringT>(format, args...);
     }
+
+    template <typename CharT, typename TraitsT, typename AllocatorT, typename FormatT, typename... Args>
+    result_code format_append(std::basic_string<CharT, TraitsT, AllocatorT>& string, FormatT const& format, Args const& ... args);
+    template <typename CharT, typename TraitsT, typename AllocatorT, typename FormatT, typename... Args>
+    result_code printf_append(std::basic_string<CharT, TraitsT, AllocatorT>& string, FormatT const& format, Args const& ... args);
+
+    template <typename CharT> class basic_scratch_string;
+
+    using scratch_string = basic_scratch_string<char>;
+    using wscratch_string = basic_scratch_string<wchar_t>;
+
+    template <typename CharT = char, typename FormatT, typename... Args> basic_scratch_string<CharT> format_scratch(FormatT const& format, Args const& ... args);
+    template <typename CharT = char, typename FormatT, typename... Args> basic_scratch_string<CharT> printf_scratch(FormatT const& format, Args const& ... args);
+
+    template <typename CharT = char> void set_scratch_capacity_limit(std::size_t capacity) noexcept;
+    template <typename CharT = char> void release_scratch_buffers() noexcept;
 } // namespace formatxx
 
+/// @internal
+namespace formatxx::_detail {
+    // rough guess of the rendered size of a single argument, used to size format_append's first growth
+    constexpr std::size_t append_estimate_per_arg = 16;
+
+    // the growth is value-initialized; resize_and_overwrite would avoid that, but it requires the
+    // callback to write every character it keeps, which is only known after formatting
+    template <typename CharT, typename TraitsT, typename AllocatorT>
+    void resize_for_overwrite(std::basic_string<CharT, TraitsT, AllocatorT>& string, std::size_t size) {
+        FORMATXX_TRACK_CAPACITY_CHANGE(string, string.resize(size));
+    }
+
+    /// Writer that copies directly into a string's storage past its original end,
+    /// growing geometrically when needed and trimming the unused tail when destroyed.
+    template <typename StringT>
+    class overwrite_writer final : public basic_format_writer<typename StringT::value_type> {
+    public:
+        using char_type = typename StringT::value_type;
+
+        overwrite_writer(StringT& string, std::size_t estimate) : _string(string), _size(string.size()) {
+            resize_for_overwrite(_string, _size + estimate);
+        }
+        ~overwrite_writer() { _string.resize(_size); }
+
+        overwrite_writer(overwrite_writer const&) = delete;
+        overwrite_writer& operator=(overwrite_writer const&) = delete;
+
+        void write(basic_string_view<char_type> str) override {
+            if (str.size() > _string.size() - _size) {
+                std::size_t const required = _size + str.size();
+                std::size_t const doubled = _string.size() * 2;
+                resize_for_overwrite(_string, required > doubled ? required : doubled);
+            }
+
+            std::memcpy(&_string[0] + _size, str.data(), sizeof(char_type) * str.size());
+            _size += str.size();
+        }
+
+    private:
+        StringT& _string;
+        std::size_t _size = 0;
+    };
+
+    /// Per-thread set of capacity-retaining strings used by format_scratch.
+    template <typename CharT>
+    struct scratch_pool {
+        // deep enough for format_value implementations that themselves use format_scratch
+        static constexpr unsigned depth = 4;
+
+        std::basic_string<CharT> buffers[depth];
+        unsigned in_use = 0;
+        std::size_t capacity_limit = 4096;
+    };
+
+    template <typename CharT>
+    scratch_pool<CharT>& thread_scratch_pool() noexcept {
+        thread_local scratch_pool<CharT> pool;
+        return pool;
+    }
+} // namespace formatxx::_detail
+
+/// A string borrowed from the calling thread's scratch pool.
+///
+/// The buffer is returned to the pool (keeping its capacity, up to the configured limit)
+/// when the handle is destroyed, so a handle must not outlive or leave its thread. When
+/// every pooled buffer is already borrowed, the handle owns a fresh string instead.
+template <typename CharT>
+class formatxx::basic_scratch_string {
+public:
+    using value_type = CharT;
+    using size_type = std::size_t;
+
+    basic_scratch_string() noexcept = default;
+    basic_scratch_string(basic_scratch_string&& rhs) noexcept { _take_from(rhs); }
+    ~basic_scratch_string() { _release(); }
+
+    basic_scratch_string& operator=(basic_scratch_string&& rhs) noexcept {
+        if (this != &rhs) {
+            _release();
+            _take_from(rhs);
+        }
+        return *this;
+    }
+
+    /// Borrow an empty buffer from the calling thread's pool.
+    static basic_scratch_string acquire() noexcept;
+
+    void append(value_type const* data, size_type length) { FORMATXX_TRACK_CAPACITY_CHANGE(_string(), _string().append(data, length)); }
+
+    bool empty() const noexcept { return size() == 0; }
+    value_type const* data() const noexcept { return _string().data(); }
+    value_type const* c_str() const noexcept { return _string().c_str(); }
+    size_type size() const noexcept { return _string().size(); }
+
+    std::basic_string_view<CharT> view() const noexcept { return { data(), size() }; }
+    operator basic_string_view<CharT>() const noexcept { return { data(), size() }; }
+
+    /// Move the contents out into an independent string; the pooled capacity goes with it.
+    std::basic_string<CharT> take() { return std::move(_string()); }
+
+private:
+    static constexpr unsigned owned_slot = ~0u;
+
+    std::basic_string<CharT>& _string() noexcept { return _pool != nullptr ? _pool->buffers[_slot] : _owned; }
+    std::basic_string<CharT> const& _string() const noexcept { return _pool != nullptr ? _pool->buffers[_slot] : _owned; }
+
+    void _take_from(basic_scratch_string& rhs) noexcept;
+    void _release() noexcept;
+
+    _detail::scratch_pool<CharT>* _pool = nullptr;
+    unsigned _slot = owned_slot;
+    std::basic_string<CharT> _owned;
+};
+
+template <typename CharT>
+auto formatxx::basic_scratch_string<CharT>::acquire() noexcept -> basic_scratch_string {
+    basic_scratch_string result;
+
+    _detail::scratch_pool<CharT>& pool = _detail::thread_scratch_pool<CharT>();
+    for (unsigned slot = 0; slot != pool.depth; ++slot) {
+        if ((pool.in_use & (1u << slot)) == 0) {
+            pool.in_use |= 1u << slot;
+            result._pool = &pool;
+            result._slot = slot;
+            break;
+        }
+    }
+
+    return result;
+}
+
+template <typename CharT>
+void formatxx::basic_scratch_string<CharT>::_take_from(basic_scratch_string& rhs) noexcept {
+    _pool = rhs._pool;
+    _slot = rhs._slot;
+    _owned = std::move(rhs._owned);
+
+    rhs._pool = nullptr;
+    rhs._slot = owned_slot;
+}
+
+template <typename CharT>
+void formatxx::basic_scratch_string<CharT>::_release() noexcept {
+    if (_pool == nullptr) {
+        return;
+    }
+
+    std::basic_string<CharT>& buffer = _pool->buffers[_slot];
+    if (buffer.capacity() > _pool->capacity_limit) {
+        std::basic_string<CharT>().swap(buffer);
+    }
+    else {
+        buffer.clear();
+    }
+
+    _pool->in_use &= ~(1u << _slot);
+    _pool = nullptr;
+    _slot = owned_slot;
+}
+
+/// Append the string format using the given parameters to the end of an existing string.
+/// The string is grown once up front by an estimate of the output size and trimmed afterward.
+/// @param string The string that will receive the formatted text.
+/// @param format The primary text and formatting controls to be written.
+/// @param args The arguments used by the formatting string.
+/// @returns a result code indicating any errors.
+template <typename CharT, typename TraitsT, typename AllocatorT, typename FormatT, typename... Args>
+formatxx::result_code formatxx::format_append(std::basic_string<CharT, TraitsT, AllocatorT>& string, FormatT const& format, Args const& ... args) {
+    basic_string_view<CharT> const format_view(format);
+    _detail::overwrite_writer writer(string, format_view.size() + sizeof...(Args) * _detail::append_estimate_per_arg);
+    return format_to(writer, format_view, args...);
+}
+
+/// Append the printf format using the given parameters to the end of an existing string.
+/// The string is grown once up front by an estimate of the output size and trimmed afterward.
+/// @param string The string that will receive the formatted text.
+/// @param format The primary text and printf controls to be written.
+/// @param args The arguments used by the formatting string.
+/// @returns a result code indicating any errors.
+template <typename CharT, typename TraitsT, typename AllocatorT, typename FormatT, typename... Args>
+formatxx::result_code formatxx::printf_append(std::basic_string<CharT, TraitsT, AllocatorT>& string, FormatT const& format, Args const& ... args) {
+    basic_string_view<CharT> const format_view(format);
+    _detail::overwrite_writer writer(string, format_view.size() + sizeof...(Args) * _detail::append_estimate_per_arg);
+    return printf_to(writer, format_view, args...);
+}
+
+/// Write the string format using the given parameters into a reusable per-thread buffer.
+/// @param format The primary text and formatting controls to be written.
+/// @param args The arguments used by the formatting string.
+/// @returns a handle to the formatted string, valid until destroyed.
+template <typename CharT, typename FormatT, typename... Args>
+formatxx::basic_scratch_string<CharT> formatxx::format_scratch(FormatT const& format, Args const& ... args) {
+    basic_scratch_string<CharT> result = basic_scratch_string<CharT>::acquire();
+    append_writer writer(result);
+    format_to(writer, format, args...);
+    return result;
+}
+
+/// Write the printf format using the given parameters into a reusable per-thread buffer.
+/// @param format The primary text and printf controls to be written.
+/// @param args The arguments used by the formatting string.
+/// @returns a handle to the formatted string, valid until destroyed.
+template <typename CharT, typename FormatT, typename... Args>
+formatxx::basic_scratch_string<CharT> formatxx::printf_scratch(FormatT const& format, Args const& ... args) {
+    basic_scratch_string<CharT> result = basic_scratch_string<CharT>::acquire();
+    append_writer writer(result);
+    printf_to(writer, format, args...);
+    return result;
+}
+
+/// Set the largest capacity the calling thread's scratch buffers keep once released.
+/// Buffers that grew beyond the limit are freed instead of being kept for reuse.
+template <typename CharT>
+void formatxx::set_scratch_capacity_limit(std::size_t capacity) noexcept {
+    _detail::thread_scratch_pool<CharT>().capacity_limit = capacity;
+}
+
+/// Free the memory held by the calling thread's idle scratch buffers.
+template <typename CharT>
+void formatxx::release_scratch_buffers() noexcept {
+    _detail::scratch_pool<CharT>& pool = _detail::thread_scratch_pool<CharT>();
+    for (unsigned slot = 0; slot != pool.depth; ++slot) {
+        if ((pool.in_use & (1u << slot)) == 0) {
+            std::basic_string<CharT>().swap(pool.buffers[slot]);
+        }
+    }
+}
+
 #endif // !defined(_guard_FORMATXX_STD_STRING_H)
@@ -0,0 +1,143 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#if !defined(_guard_FORMATXX_STRUCTURED_H)
+#define _guard_FORMATXX_STRUCTURED_H
+#pragma once
+
+#include "formatxx/format.h"
+
+namespace formatxx {
+    template <typename CharT> class basic_field_sink;
+    class logfmt_sink;
+    class json_sink;
+
+    enum class field_kind : unsigned char;
+
+    using field_sink = basic_field_sink<char>;
+    using wfield_sink = basic_field_sink<wchar_t>;
+
+    template <typename CharT, typename FormatT, typename... Args>
+    constexpr result_code format_structured(basic_format_writer<CharT>& writer, basic_field_sink<CharT>& sink, FormatT const& format, Args const& ... args);
+}
+
+namespace formatxx::_detail {
+    template <typename CharT>
+    FORMATXX_PUBLIC result_code FORMATXX_API structured_impl(basic_format_writer<CharT>& out, basic_field_sink<CharT>& sink, basic_string_view<CharT> format, basic_format_arg_list<CharT> args);
+
+    FORMATXX_PUBLIC field_kind FORMATXX_API field_kind_of(format_arg_type type) noexcept;
+}
+
+/// What kind of value a structured field holds, for emitters that type their output.
+enum class formatxx::field_kind : unsigned char {
+    /// text, characters, pointers and user-defined types
+    string,
+    integer,
+    floating,
+    boolean,
+    /// a nullptr argument
+    null
+};
+
+/// Receives each formatted argument as a named field alongside the message text.
+///
+/// For every replacement field, format_structured calls begin_field, then passes the
+/// argument's rendered text to value in one or more pieces as it is written to the message,
+/// then calls end_field. Fields from named placeholders such as {user} carry that name;
+/// other fields have an empty name and are identified by their argument index.
+template <typename CharT>
+class formatxx::basic_field_sink {
+public:
+    virtual ~basic_field_sink() = default;
+
+    virtual void begin_record() {}
+    virtual void begin_field(basic_string_view<CharT> name, unsigned index, field_kind kind) = 0;
+    virtual void value(basic_string_view<CharT> text) = 0;
+    virtual void end_field() = 0;
+    virtual void end_record() {}
+};
+
+/// Emits fields as logfmt: name=value pairs separated by spaces.
+///
+/// Numbers, booleans and nulls are written bare; other values are quoted, with quotes,
+/// backslashes and line breaks escaped. Unnamed fields are written as argN.
+class formatxx::logfmt_sink final : public formatxx::field_sink {
+public:
+    explicit logfmt_sink(format_writer& out) noexcept : _out(out) {}
+
+    FORMATXX_PUBLIC void FORMATXX_API begin_record() override;
+    FORMATXX_PUBLIC void FORMATXX_API begin_field(string_view name, unsigned index, field_kind kind) override;
+    FORMATXX_PUBLIC void FORMATXX_API value(string_view text) override;
+    FORMATXX_PUBLIC void FORMATXX_API end_field() override;
+
+private:
+    format_writer& _out;
+    bool _first = true;
+    bool _quoted = false;
+};
+
+/// Emits fields as the members of one JSON object per record.
+///
+/// Numbers and booleans are written as JSON literals, nullptr as null, and everything else
+/// as an escaped JSON string. Unnamed fields are written as "argN".
+class formatxx::json_sink final : public formatxx::field_sink {
+public:
+    explicit json_sink(format_writer& out) noexcept : _out(out) {}
+
+    FORMATXX_PUBLIC void FORMATXX_API begin_record() override;
+    FORMATXX_PUBLIC void FORMATXX_API begin_field(string_view name, unsigned index, field_kind kind) override;
+    FORMATXX_PUBLIC void FORMATXX_API value(string_view text) override;
+    FORMATXX_PUBLIC void FORMATXX_API end_field() override;
+    FORMATXX_PUBLIC void FORMATXX_API end_record() override;
+
+private:
+    format_writer& _out;
+    bool _first = true;
+    field_kind _kind = field_kind::string;
+};
+
+extern template FORMATXX_PUBLIC formatxx::result_code FORMATXX_API formatxx::_detail::structured_impl(basic_format_writer<char>& out, basic_field_sink<char>& sink, basic_string_view<char> format, basic_format_arg_list<char> args);
+extern template FORMATXX_PUBLIC formatxx::result_code FORMATXX_API formatxx::_detail::structured_impl(basic_format_writer<wchar_t>& out, basic_field_sink<wchar_t>& sink, basic_string_view<wchar_t> format, basic_format_arg_list<wchar_t> args);
+
+/// Write the string format into a buffer while reporting each argument to a field sink.
+///
+/// Each argument is rendered once; its text goes both into the message and to the sink.
+/// @param writer The write buffer that will receive the formatted message.
+/// @param sink Receives one field per replacement field in the format string.
+/// @param format The primary text and formatting controls to be written.
+/// @param args The arguments used by the formatting string.
+/// @returns a result code indicating any errors.
+template <typename CharT, typename FormatT, typename... Args>
+constexpr formatxx::result_code formatxx::format_structured(basic_format_writer<CharT>& writer, basic_field_sink<CharT>& sink, FormatT const& format, Args const& ... args) {
+    return _detail::structured_impl(writer, sink, basic_string_view<CharT>(format), { _detail::make_format_arg<CharT, _detail::formattable_t<Args>>(args)... });
+}
+
+#endif // !defined(_guard_FORMATXX_STRUCTURED_H)
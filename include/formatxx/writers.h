@@ -33,12 +33,28 @@
 #pragma once
 
 #include "formatxx/format.h"
+#include "formatxx/allocation_tracking.h"
 #include "formatxx/_detail/append_writer.h"
 #include <cstring>
 
 namespace formatxx {
     template <typename ContainerT> class container_writer;
     template <typename CharT> class span_writer;
+    template <typename CharT, std::size_t MaxChildren = 4> class tee_writer;
+    class fd_writer;
+    class iovec_writer;
+
+    struct io_span;
+    enum class fd_flush : unsigned char;
+
+    /// Per-thread writer for standard output.
+    ///
+    /// Buffers up to PIPE_BUF bytes per thread and writes each batch of complete lines with a
+    /// single write call, so lines from different threads never tear when stdout is a pipe.
+    /// Partial lines stay buffered until completed, flushed, or the thread exits.
+    FORMATXX_PUBLIC fd_writer& FORMATXX_API stdout_writer() noexcept;
+    /// Per-thread writer for standard error; see stdout_writer().
+    FORMATXX_PUBLIC fd_writer& FORMATXX_API stderr_writer() noexcept;
 }
 
 namespace formatxx::_detail {
@@ -50,8 +66,41 @@ namespace formatxx::_detail {
 
     template <typename T>
     using iterator_value_t = typename iterator_traits<T>::value_type;
+
+    /// Copy as much of str as fits between cursor and end.
+    /// @returns the number of characters copied.
+    template <typename CharT>
+    std::size_t copy_clamped(CharT* cursor, CharT const* end, basic_string_view<CharT> str) noexcept {
+        std::size_t const available = end - cursor;
+        std::size_t const length = available < str.size() ? available : str.size();
+
+        std::memcpy(cursor, str.data(), length * sizeof(CharT));
+        return length;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API write_fd(int fd, void const* data, std::size_t size) noexcept;
+    FORMATXX_PUBLIC result_code FORMATXX_API write_fd_spans(int fd, io_span* spans, std::size_t count) noexcept;
+
+    template <typename T, typename = void>
+    struct has_char_data : std::false_type {};
+    template <typename T>
+    struct has_char_data<T, std::void_t<decltype(string_view(std::declval<T const&>().data(), std::declval<T const&>().size()))>> : std::true_type {};
 }
 
+/// A borrowed or buffered region of output, layout-compatible with POSIX iovec.
+struct formatxx::io_span {
+    void const* data = nullptr;
+    std::size_t size = 0;
+};
+
+/// When an fd_writer writes out its buffer, besides when full or explicitly flushed.
+enum class formatxx::fd_flush : unsigned char {
+    /// only when the buffer is full
+    threshold,
+    /// also after every complete line
+    newline
+};
+
 /// Writer that calls insert(end, range_begin, range_end) on wrapped value.
 template <typename ContainerT>
 class formatxx::container_writer final : public formatxx::basic_format_writer<typename ContainerT::value_type> {
@@ -59,7 +108,7 @@ public:
     constexpr container_writer(ContainerT & container) : _container(container) {}
 
     constexpr void write(basic_string_view<typename ContainerT::value_type> str) override {
-        _container.insert(_container.end(), str.begin(), str.end());
+        FORMATXX_TRACK_CAPACITY_CHANGE(_container, _container.insert(_container.end(), str.begin(), str.end()));
     }
 
 private:
@@ -79,13 +128,7 @@ public:
     }
 
     void write(basic_string_view<CharT> str) override {
-        std::size_t const size = _cursor - _buffer;
-        std::size_t const capacity = _length - 1;
-        std::size_t const available = capacity - size;
-        std::size_t const length = available < str.size() ? available : str.size();
-
-        std::memcpy(_cursor, str.data(), length * sizeof(CharT));
-        _cursor += length;
+        _cursor += _detail::copy_clamped(_cursor, _buffer + _length - 1/*NUL*/, str);
         *_cursor = CharT{};
     }
 
@@ -95,4 +138,315 @@ private:
     std::size_t _length = 0;
 };
 
+/// Writer that forwards each fragment of a single formatting pass to several child writers.
+///
+/// Children are held in a fixed-capacity list. Each child carries a mask of the channels it
+/// accepts; only children whose mask intersects the currently selected channels receive
+/// output, so sinks can be switched per message without formatting more than once.
+template <typename CharT, std::size_t MaxChildren>
+class formatxx::tee_writer final : public formatxx::basic_format_writer<CharT> {
+public:
+    using mask_type = unsigned long long;
+
+    static constexpr mask_type all_channels = ~mask_type(0);
+
+    static_assert(MaxChildren > 0, "tee_writer requires room for at least one child");
+
+    constexpr tee_writer() noexcept = default;
+    template <typename... WriterTs, typename = std::enable_if_t<(std::is_base_of_v<basic_format_writer<CharT>, WriterTs> && ...)>>
+    constexpr explicit tee_writer(WriterTs& ... children) noexcept : _children{ &children... }, _masks{ (static_cast<void>(children), all_channels)... }, _count(sizeof...(WriterTs)) {
+        static_assert(sizeof...(WriterTs) <= MaxChildren, "too many children for tee_writer");
+    }
+
+    void write(basic_string_view<CharT> str) override {
+        for (std::size_t index = 0; index != _count; ++index) {
+            if ((_masks[index] & _selected) != 0) {
+                _children[index]->write(str);
+            }
+        }
+    }
+
+    /// Add a child receiving the given channels.
+    /// @returns false if the list is full.
+    constexpr bool add(basic_format_writer<CharT>& child, mask_type channels = all_channels) noexcept {
+        if (_count == MaxChildren) {
+            return false;
+        }
+        _children[_count] = &child;
+        _masks[_count] = channels;
+        ++_count;
+        return true;
+    }
+
+    constexpr void clear() noexcept { _count = 0; }
+
+    /// Change the channels a child receives; 0 disables it.
+    constexpr void set_channels(std::size_t index, mask_type channels) noexcept { _masks[index] = channels; }
+    constexpr mask_type channels(std::size_t index) const noexcept { return _masks[index]; }
+
+    /// Select the channels subsequent output is sent to.
+    constexpr void select(mask_type channels) noexcept { _selected = channels; }
+    constexpr mask_type selected() const noexcept { return _selected; }
+
+    constexpr std::size_t size() const noexcept { return _count; }
+    static constexpr std::size_t capacity() noexcept { return MaxChildren; }
+
+private:
+    basic_format_writer<CharT>* _children[MaxChildren] = {};
+    mask_type _masks[MaxChildren] = {};
+    std::size_t _count = 0;
+    mask_type _selected = all_channels;
+};
+
+/// Writer that buffers output for a file descriptor, minimizing the number of write calls.
+///
+/// Fragments too large for the buffer are written straight through. The first I/O error
+/// is kept and reported by result() and flush(); buffered output is dropped on error.
+class formatxx::fd_writer final : public formatxx::format_writer {
+public:
+    template <std::size_t Count>
+    fd_writer(int fd, char(&buffer)[Count], fd_flush mode = fd_flush::threshold) noexcept : fd_writer(fd, buffer, Count, mode) {}
+    fd_writer(int fd, char* buffer, std::size_t capacity, fd_flush mode = fd_flush::threshold) noexcept : _buffer(buffer), _capacity(capacity), _fd(fd), _mode(mode) {}
+    ~fd_writer() { flush(); }
+
+    fd_writer(fd_writer const&) = delete;
+    fd_writer& operator=(fd_writer const&) = delete;
+
+    void write(string_view str) override;
+
+    /// Write out any buffered output.
+    /// @returns the first error encountered by this writer, if any.
+    result_code flush() noexcept;
+
+    result_code result() const noexcept { return _result; }
+    int fd() const noexcept { return _fd; }
+
+private:
+    void _write_out(char const* data, std::size_t size) noexcept;
+
+    char* _buffer = nullptr;
+    std::size_t _capacity = 0;
+    std::size_t _size = 0;
+    int _fd = -1;
+    fd_flush _mode = fd_flush::threshold;
+    result_code _result = result_code::success;
+};
+
+inline void formatxx::fd_writer::write(string_view str) {
+    if (str.size() > _capacity - _size) {
+        flush();
+
+        if (str.size() >= _capacity) {
+            _write_out(str.data(), str.size());
+            return;
+        }
+    }
+
+    std::memcpy(_buffer + _size, str.data(), str.size());
+    _size += str.size();
+
+    if (_mode == fd_flush::newline) {
+        // write out all complete lines, keeping any partial trailing line buffered
+        char const* const newline = static_cast<char const*>(std::memchr(str.data(), '\n', str.size()));
+        if (newline != nullptr) {
+            std::size_t end = _size;
+            while (_buffer[end - 1] != '\n') {
+                --end;
+            }
+
+            _write_out(_buffer, end);
+            std::memmove(_buffer, _buffer + end, _size - end);
+            _size -= end;
+        }
+    }
+}
+
+inline formatxx::result_code formatxx::fd_writer::flush() noexcept {
+    if (_size != 0) {
+        _write_out(_buffer, _size);
+        _size = 0;
+    }
+    return _result;
+}
+
+inline void formatxx::fd_writer::_write_out(char const* data, std::size_t size) noexcept {
+    result_code const result = _detail::write_fd(_fd, data, size);
+    if (result != result_code::success && _result == result_code::success) {
+        _result = result;
+    }
+}
+
+/// Writer that gathers output into a list of spans for a single writev call.
+///
+/// When formatting through format() or printf(), fragments of at least the borrow threshold
+/// that lie within the format string or within a string argument (character pointers,
+/// or types with char data() and size()) are recorded by pointer instead of copied.
+/// Everything else, such as rendered numbers, padding, and text from nested format calls,
+/// is copied into the caller-provided side buffer.
+///
+/// Borrowed pointers remain valid only as long as the caller keeps the format string and
+/// arguments alive; the batch must be flushed (or consumed through spans()) before then.
+/// The writer flushes by itself when its span list or side buffer fills mid-format.
+class formatxx::iovec_writer final : public formatxx::format_writer {
+public:
+    static constexpr std::size_t max_spans = 64;
+    static constexpr std::size_t max_stable_ranges = 8;
+
+    static constexpr std::size_t default_borrow_threshold = 64;
+
+    template <std::size_t Count>
+    iovec_writer(int fd, char(&buffer)[Count]) noexcept : iovec_writer(fd, buffer, Count) {}
+    iovec_writer(int fd, char* buffer, std::size_t capacity) noexcept : _buffer(buffer), _capacity(capacity), _fd(fd) {}
+    ~iovec_writer() { flush(); }
+
+    iovec_writer(iovec_writer const&) = delete;
+    iovec_writer& operator=(iovec_writer const&) = delete;
+
+    void write(string_view str) override;
+
+    /// Format into the batch, borrowing large fragments of the format string and string arguments.
+    template <typename FormatT, typename... Args> result_code format(FormatT const& format, Args const& ... args);
+    /// Printf-format into the batch, borrowing large fragments of the format string and string arguments.
+    template <typename FormatT, typename... Args> result_code printf(FormatT const& format, Args const& ... args);
+
+    /// Write out the gathered spans with writev.
+    /// @returns the first error encountered by this writer, if any.
+    result_code flush() noexcept;
+
+    /// Spans gathered so far, for callers handing the batch to sendmsg or similar.
+    io_span const* spans() const noexcept { return _spans; }
+    std::size_t span_count() const noexcept { return _span_count; }
+
+    /// Forget the gathered spans without writing them.
+    void clear() noexcept { _span_count = 0; _used = 0; }
+
+    result_code result() const noexcept { return _result; }
+
+    /// Set the smallest fragment size worth borrowing instead of copying.
+    void set_borrow_threshold(std::size_t threshold) noexcept { _threshold = threshold; }
+
+private:
+    template <typename T> void _add_stable_arg(T const& arg) noexcept;
+    void _add_stable(string_view range) noexcept;
+    bool _is_stable(string_view str) const noexcept;
+    void _fail(result_code result) noexcept;
+
+    io_span _spans[max_spans];
+    string_view _stable[max_stable_ranges];
+    char* _buffer = nullptr;
+    std::size_t _capacity = 0;
+    std::size_t _used = 0;
+    std::size_t _threshold = default_borrow_threshold;
+    std::size_t _span_count = 0;
+    std::size_t _stable_count = 0;
+    int _fd = -1;
+    result_code _result = result_code::success;
+};
+
+inline void formatxx::iovec_writer::write(string_view str) {
+    if (str.empty()) {
+        return;
+    }
+
+    if (str.size() >= _threshold && _is_stable(str)) {
+        if (_span_count == max_spans) {
+            flush();
+        }
+        _spans[_span_count++] = { str.data(), str.size() };
+        return;
+    }
+
+    if (str.size() > _capacity - _used || _span_count == max_spans) {
+        flush();
+
+        if (str.size() > _capacity) {
+            // too large to copy; borrowed spans were already written, so ordering is preserved
+            _fail(_detail::write_fd(_fd, str.data(), str.size()));
+            return;
+        }
+    }
+
+    char* const dest = _buffer + _used;
+    std::memcpy(dest, str.data(), str.size());
+    _used += str.size();
+
+    // extend the previous span if it ends exactly where this copy begins
+    if (_span_count != 0 && static_cast<char const*>(_spans[_span_count - 1].data) + _spans[_span_count - 1].size == dest) {
+        _spans[_span_count - 1].size += str.size();
+    }
+    else {
+        _spans[_span_count++] = { dest, str.size() };
+    }
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::iovec_writer::format(FormatT const& format, Args const& ... args) {
+    string_view const format_view(format);
+
+    _stable_count = 0;
+    _add_stable(format_view);
+    (_add_stable_arg(args), ...);
+
+    result_code const result = format_to(*this, format_view, args...);
+    _stable_count = 0;
+    return result;
+}
+
+template <typename FormatT, typename... Args>
+formatxx::result_code formatxx::iovec_writer::printf(FormatT const& format, Args const& ... args) {
+    string_view const format_view(format);
+
+    _stable_count = 0;
+    _add_stable(format_view);
+    (_add_stable_arg(args), ...);
+
+    result_code const result = printf_to(*this, format_view, args...);
+    _stable_count = 0;
+    return result;
+}
+
+inline formatxx::result_code formatxx::iovec_writer::flush() noexcept {
+    if (_span_count != 0) {
+        _fail(_detail::write_fd_spans(_fd, _spans, _span_count));
+    }
+    clear();
+    return _result;
+}
+
+template <typename T>
+void formatxx::iovec_writer::_add_stable_arg(T const& arg) noexcept {
+    using arg_type = _detail::formattable_t<T>;
+
+    if constexpr (std::is_same_v<arg_type, char const*> || std::is_same_v<arg_type, char*>) {
+        if (arg != nullptr) {
+            _add_stable(string_view(arg));
+        }
+    }
+    else if constexpr (_detail::has_char_data<T>::value) {
+        _add_stable(string_view(arg.data(), arg.size()));
+    }
+}
+
+inline void formatxx::iovec_writer::_add_stable(string_view range) noexcept {
+    if (_stable_count != max_stable_ranges) {
+        _stable[_stable_count++] = range;
+    }
+}
+
+inline bool formatxx::iovec_writer::_is_stable(string_view str) const noexcept {
+    for (std::size_t index = 0; index != _stable_count; ++index) {
+        string_view const range = _stable[index];
+        if (str.data() >= range.data() && str.data() + str.size() <= range.data() + range.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void formatxx::iovec_writer::_fail(result_code result) noexcept {
+    if (result != result_code::success && _result == result_code::success) {
+        _result = result;
+    }
+}
+
 #endif // !defined(_guard_FORMATXX_WRITERS_H)
@@ -0,0 +1,126 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/allocation_tracking.h>
+
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+
+#include <cstdint>
+
+namespace {
+    // fixed-size so that tracking never allocates itself; further formats only count toward the totals
+    constexpr std::size_t max_tracked_formats = 64;
+
+    struct tracked_format {
+        std::uint64_t hash = 0;
+        std::size_t bytes = 0;
+        formatxx::allocation_stats stats;
+    };
+
+    struct tracking_state {
+        formatxx::allocation_stats totals;
+        void const* format = nullptr;
+        std::size_t format_bytes = 0;
+        std::size_t format_count = 0;
+        tracked_format formats[max_tracked_formats];
+    };
+
+    thread_local tracking_state state;
+
+    // FNV-1a; formats are matched by content as the original pointer may not outlive the call
+    std::uint64_t hash_bytes(void const* data, std::size_t bytes) noexcept {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (std::size_t i = 0; i != bytes; ++i) {
+            hash ^= static_cast<unsigned char const*>(data)[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    tracked_format* find_format(std::uint64_t hash, std::size_t bytes) noexcept {
+        for (std::size_t i = 0; i != state.format_count; ++i) {
+            if (state.formats[i].hash == hash && state.formats[i].bytes == bytes) {
+                return &state.formats[i];
+            }
+        }
+        return nullptr;
+    }
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC allocation_stats FORMATXX_API allocation_totals() noexcept {
+        return state.totals;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API reset_allocation_stats() noexcept {
+        state.totals = {};
+        state.format_count = 0;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API _detail::track_allocation(std::size_t bytes) noexcept {
+        ++state.totals.count;
+        state.totals.bytes += bytes;
+
+        if (state.format == nullptr) {
+            return;
+        }
+
+        std::uint64_t const hash = hash_bytes(state.format, state.format_bytes);
+        tracked_format* entry = find_format(hash, state.format_bytes);
+        if (entry == nullptr) {
+            if (state.format_count == max_tracked_formats) {
+                return;
+            }
+
+            entry = &state.formats[state.format_count++];
+            *entry = {};
+            entry->hash = hash;
+            entry->bytes = state.format_bytes;
+        }
+
+        ++entry->stats.count;
+        entry->stats.bytes += bytes;
+    }
+
+    FORMATXX_PUBLIC void const* FORMATXX_API _detail::exchange_tracked_format(void const* format, std::size_t bytes, std::size_t* previous_bytes) noexcept {
+        void const* const previous = state.format;
+        *previous_bytes = state.format_bytes;
+        state.format = format;
+        state.format_bytes = bytes;
+        return previous;
+    }
+
+    FORMATXX_PUBLIC allocation_stats FORMATXX_API _detail::tracked_format_stats(void const* format, std::size_t bytes) noexcept {
+        tracked_format const* const entry = find_format(hash_bytes(format, bytes), bytes);
+        return entry != nullptr ? entry->stats : allocation_stats{};
+    }
+} // namespace formatxx
+
+#endif // defined(FORMATXX_TRACK_ALLOCATIONS)
@@ -0,0 +1,235 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/async_logger.h>
+#include <formatxx/allocation_tracking.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace {
+    constexpr std::size_t cell_alignment = 64;
+    constexpr unsigned spin_limit = 64;
+}
+
+/// Consumer thread and the synchronization used to park it.
+class formatxx::_detail::async_logger_worker {
+public:
+    async_logger_worker(async_logger& logger, format_writer& sink, string_view separator) : _logger(logger), _sink(sink), _separator(separator) {
+        _thread = std::thread([this] { _run(); });
+    }
+
+    void wake() noexcept {
+        { std::lock_guard<std::mutex> lock(_mutex); }
+        _condition.notify_all();
+    }
+
+    void stop() noexcept {
+        if (_thread.joinable()) {
+            _stopping.store(true, std::memory_order_release);
+            wake();
+            _thread.join();
+        }
+    }
+
+    void wait_for(std::size_t position) noexcept {
+        // seq_cst pairs with the consumer's store of _processed and load of _flush_waiters:
+        // either the consumer sees this waiter or the predicate sees the progress
+        _flush_waiters.fetch_add(1, std::memory_order_seq_cst);
+        wake();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto const done = [this, position] { return _processed.load(std::memory_order_seq_cst) >= position || _finished.load(std::memory_order_acquire); };
+        // the timeout is only a backstop; every wake-up re-checks the predicate
+        while (!_condition.wait_for(lock, std::chrono::milliseconds(10), done)) {}
+
+        _flush_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    void _run() noexcept;
+
+    async_logger& _logger;
+    format_writer& _sink;
+    string_view _separator;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::atomic<std::size_t> _processed = 0;
+    std::atomic<unsigned> _flush_waiters = 0;
+    std::atomic<bool> _stopping = false;
+    std::atomic<bool> _finished = false;
+    std::thread _thread;
+};
+
+void formatxx::_detail::async_logger_worker::_run() noexcept {
+    std::size_t position = _logger._dequeue.load(std::memory_order_relaxed);
+    unsigned idle = 0;
+
+    for (;;) {
+        async_logger::cell& slot = _logger._cell(position);
+        if (slot.sequence.load(std::memory_order_acquire) == position + 1) {
+            if (slot.size != 0) {
+                format_record(_sink, async_logger::_data(slot));
+                _sink.write(_separator);
+            }
+
+            slot.sequence.store(position + _logger._mask + 1, std::memory_order_release);
+            ++position;
+            _logger._dequeue.store(position, std::memory_order_release);
+            _processed.store(position, std::memory_order_seq_cst);
+
+            if (_flush_waiters.load(std::memory_order_seq_cst) != 0) {
+                wake();
+            }
+            idle = 0;
+            continue;
+        }
+
+        // every claimed record is eventually published, so stop only once caught up; seq_cst
+        // orders this load against a producer's claim and its re-check of _stopped
+        if (_stopping.load(std::memory_order_acquire) && position == _logger._enqueue.load(std::memory_order_seq_cst)) {
+            break;
+        }
+
+        if (++idle < spin_limit) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _logger._sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1 && !_stopping.load(std::memory_order_acquire)) {
+            // the timeout bounds the delay should a producer miss the sleeping flag
+            _condition.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        _logger._sleeping.store(false, std::memory_order_relaxed);
+        idle = 0;
+    }
+
+    _finished.store(true, std::memory_order_release);
+    wake();
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC FORMATXX_API async_logger::async_logger(format_writer& sink, async_logger_options const& options) : _slot_size(options.slot_size), _overflow(options.overflow) {
+        std::size_t count = 2;
+        while (count < options.queue_size) {
+            count <<= 1;
+        }
+
+        _mask = count - 1;
+        _stride = (cell_header + _slot_size + cell_alignment - 1) / cell_alignment * cell_alignment;
+        _cells = static_cast<unsigned char*>(::operator new(_stride * count, std::align_val_t(cell_alignment)));
+        FORMATXX_TRACK_ALLOCATION(_stride * count);
+
+        for (std::size_t position = 0; position != count; ++position) {
+            cell* const slot = new (_cells + position * _stride) cell;
+            slot->sequence.store(position, std::memory_order_relaxed);
+            slot->size = 0;
+        }
+
+        _worker = new _detail::async_logger_worker(*this, sink, options.separator);
+    }
+
+    FORMATXX_PUBLIC FORMATXX_API async_logger::~async_logger() {
+        shutdown();
+        delete _worker;
+        ::operator delete(_cells, std::align_val_t(cell_alignment));
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API async_logger::flush() noexcept {
+        _worker->wait_for(_enqueue.load(std::memory_order_acquire));
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API async_logger::shutdown() noexcept {
+        _stopped.store(true, std::memory_order_release);
+        _worker->stop();
+    }
+
+    FORMATXX_PUBLIC async_logger::cell* FORMATXX_API async_logger::_claim() noexcept {
+        std::size_t position = _enqueue.load(std::memory_order_relaxed);
+        unsigned attempt = 0;
+
+        while (!_stopped.load(std::memory_order_seq_cst)) {
+            cell& slot = _cell(position);
+            std::size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (difference == 0) {
+                if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    // the consumer may already have drained and exited; hand the slot back empty
+                    if (_stopped.load(std::memory_order_seq_cst)) {
+                        _publish(slot, 0);
+                        return nullptr;
+                    }
+                    return &slot;
+                }
+                continue;
+            }
+
+            if (difference < 0) {
+                // the queue is full
+                if (_overflow == overflow_policy::drop_and_count) {
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (_overflow != overflow_policy::block) {
+                    return nullptr;
+                }
+                if (++attempt >= spin_limit) {
+                    std::this_thread::yield();
+                }
+            }
+
+            position = _enqueue.load(std::memory_order_relaxed);
+        }
+
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API async_logger::_publish(cell& slot, std::size_t size) noexcept {
+        if (size == 0) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        slot.size = static_cast<std::uint32_t>(size);
+        slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_sleeping.load(std::memory_order_relaxed)) {
+            _worker->wake();
+        }
+    }
+} // namespace formatxx
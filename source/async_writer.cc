@@ -0,0 +1,437 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/async_writer.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(FORMATXX_USE_LIBURING)
+#   include <liburing.h>
+#   include <cerrno>
+#   include <unistd.h>
+#endif
+
+/// Owns the output buffers and moves filled buffers to the file descriptor.
+class formatxx::_detail::async_backend {
+public:
+    async_backend(int fd, async_writer_options const& options) :
+        _memory(new char[options.buffer_size * options.buffer_count]),
+        _free(new unsigned[options.buffer_count]),
+        _buffer_size(options.buffer_size),
+        _buffer_count(options.buffer_count),
+        _fd(fd) {
+        for (unsigned index = 0; index != _buffer_count; ++index) {
+            _free[index] = index;
+        }
+        _free_count = _buffer_count;
+    }
+    virtual ~async_backend() = default;
+
+    /// Take a free buffer, optionally waiting for one to complete.
+    virtual bool acquire(unsigned& index, bool wait) noexcept = 0;
+    /// Hand a filled buffer off to be written.
+    virtual void submit(unsigned index, std::size_t size) noexcept = 0;
+    /// Wait for every submitted buffer to be written.
+    virtual void fence() noexcept = 0;
+
+    virtual bool uses_io_uring() const noexcept { return false; }
+
+    char* buffer(unsigned index) const noexcept { return _memory.get() + index * _buffer_size; }
+    std::size_t buffer_size() const noexcept { return _buffer_size; }
+
+    result_code result() const noexcept { return _result.load(std::memory_order_acquire); }
+
+protected:
+    void fail(result_code result) noexcept {
+        result_code expected = result_code::success;
+        if (result != result_code::success) {
+            _result.compare_exchange_strong(expected, result, std::memory_order_acq_rel);
+        }
+    }
+
+    std::unique_ptr<char[]> _memory;
+    std::unique_ptr<unsigned[]> _free;
+    std::size_t _buffer_size = 0;
+    unsigned _buffer_count = 0;
+    unsigned _free_count = 0;
+    unsigned _in_flight = 0;
+    int _fd = -1;
+
+private:
+    std::atomic<result_code> _result = result_code::success;
+};
+
+namespace {
+    using namespace formatxx;
+
+    /// Backend writing buffers in order from a dedicated thread with blocking writes.
+    class thread_backend final : public _detail::async_backend {
+    public:
+        thread_backend(int fd, async_writer_options const& options) :
+            async_backend(fd, options),
+            _pending(new pending[options.buffer_count]) {
+            _worker = std::thread([this] { _run(); });
+        }
+
+        ~thread_backend() override {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _condition.notify_all();
+            _worker.join();
+        }
+
+        bool acquire(unsigned& index, bool wait) noexcept override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (wait) {
+                _condition.wait(lock, [this] { return _free_count != 0; });
+            }
+            else if (_free_count == 0) {
+                return false;
+            }
+
+            index = _free[--_free_count];
+            return true;
+        }
+
+        void submit(unsigned index, std::size_t size) noexcept override {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _pending[(_pending_head + _pending_count) % _buffer_count] = { index, size };
+                ++_pending_count;
+                ++_in_flight;
+            }
+            _condition.notify_all();
+        }
+
+        void fence() noexcept override {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _in_flight == 0; });
+        }
+
+    private:
+        struct pending {
+            unsigned index;
+            std::size_t size;
+        };
+
+        void _run() noexcept {
+            std::unique_lock<std::mutex> lock(_mutex);
+            for (;;) {
+                _condition.wait(lock, [this] { return _pending_count != 0 || _stopping; });
+                if (_pending_count == 0) {
+                    return;
+                }
+
+                pending const next = _pending[_pending_head];
+                _pending_head = (_pending_head + 1) % _buffer_count;
+                --_pending_count;
+
+                lock.unlock();
+                fail(_detail::write_fd(_fd, buffer(next.index), next.size));
+                lock.lock();
+
+                _free[_free_count++] = next.index;
+                --_in_flight;
+                _condition.notify_all();
+            }
+        }
+
+        std::unique_ptr<pending[]> _pending;
+        unsigned _pending_head = 0;
+        unsigned _pending_count = 0;
+        bool _stopping = false;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::thread _worker;
+    };
+
+#if defined(FORMATXX_USE_LIBURING)
+    /// Backend submitting buffers through io_uring from the formatting thread.
+    ///
+    /// Regular files are written at explicit offsets so buffers may complete in any order;
+    /// pipes and other unseekable descriptors have one write in the ring at a time, and a
+    /// short write is resubmitted before the next buffer so output is never reordered.
+    class uring_backend final : public _detail::async_backend {
+    public:
+        static std::unique_ptr<uring_backend> create(int fd, async_writer_options const& options) {
+            std::unique_ptr<uring_backend> backend(new uring_backend(fd, options));
+            if (::io_uring_queue_init(options.buffer_count, &backend->_ring, 0) < 0) {
+                return nullptr;
+            }
+            backend->_initialized = true;
+            return backend;
+        }
+
+        ~uring_backend() override {
+            if (_initialized) {
+                fence();
+                if (_seekable) {
+                    ::lseek(_fd, static_cast<off_t>(_offset), SEEK_SET);
+                }
+                ::io_uring_queue_exit(&_ring);
+            }
+        }
+
+        bool uses_io_uring() const noexcept override { return true; }
+
+        bool acquire(unsigned& index, bool wait) noexcept override {
+            while (_reap(/*wait=*/false)) {}
+
+            while (_free_count == 0) {
+                if (!wait || !_reap(/*wait=*/true)) {
+                    return false;
+                }
+            }
+
+            index = _free[--_free_count];
+            return true;
+        }
+
+        void submit(unsigned index, std::size_t size) noexcept override {
+            _sizes[index] = size;
+            _written[index] = 0;
+            _offsets[index] = _offset;
+            _offset += size;
+            ++_in_flight;
+
+            if (_seekable) {
+                _write(index);
+                return;
+            }
+
+            // the front of the queue is the buffer currently in the ring
+            _queue[(_queue_head + _queue_count) % _buffer_count] = index;
+            if (++_queue_count == 1) {
+                _write(index);
+            }
+        }
+
+        void fence() noexcept override {
+            while (_in_flight != 0 && _reap(/*wait=*/true)) {}
+        }
+
+    private:
+        uring_backend(int fd, async_writer_options const& options) :
+            async_backend(fd, options),
+            _sizes(new std::size_t[options.buffer_count]),
+            _written(new std::size_t[options.buffer_count]),
+            _offsets(new std::uint64_t[options.buffer_count]),
+            _queue(new unsigned[options.buffer_count]) {
+            off_t const position = ::lseek(fd, 0, SEEK_CUR);
+            _seekable = position != static_cast<off_t>(-1);
+            _offset = _seekable ? static_cast<std::uint64_t>(position) : 0;
+        }
+
+        bool _reap(bool wait) noexcept {
+            if (_in_flight == 0) {
+                return false;
+            }
+
+            io_uring_cqe* cqe = nullptr;
+            int const error = wait ? ::io_uring_wait_cqe(&_ring, &cqe) : ::io_uring_peek_cqe(&_ring, &cqe);
+            if (error < 0 || cqe == nullptr) {
+                if (wait && error != -EINTR && error != -EAGAIN) {
+                    fail(result_code::io_error);
+                }
+                return false;
+            }
+
+            unsigned const index = static_cast<unsigned>(reinterpret_cast<std::uintptr_t>(::io_uring_cqe_get_data(cqe)));
+            int const written = cqe->res;
+            ::io_uring_cqe_seen(&_ring, cqe);
+
+            if (written < 0) {
+                fail(result_code::io_error);
+            }
+            else {
+                _written[index] += static_cast<std::size_t>(written);
+                if (_written[index] < _sizes[index]) {
+                    if (written != 0) {
+                        // resubmit the remainder before anything queued behind it
+                        _write(index);
+                        return true;
+                    }
+                    fail(result_code::io_error);
+                }
+            }
+
+            _release(index);
+            return true;
+        }
+
+        // submit the unwritten part of a buffer
+        void _write(unsigned index) noexcept {
+            io_uring_sqe* const sqe = ::io_uring_get_sqe(&_ring);
+            if (sqe == nullptr) {
+                // cannot happen with one queue entry per buffer, but never lose the output
+                _complete(index);
+                _release(index);
+                return;
+            }
+
+            std::size_t const written = _written[index];
+            ::io_uring_prep_write(sqe, _fd, buffer(index) + written, static_cast<unsigned>(_sizes[index] - written), _seekable ? _offsets[index] + written : static_cast<std::uint64_t>(-1));
+            ::io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<std::uintptr_t>(index)));
+
+            if (::io_uring_submit(&_ring) < 0) {
+                fail(result_code::io_error);
+            }
+        }
+
+        // return a finished buffer and start the next queued one
+        void _release(unsigned index) noexcept {
+            _free[_free_count++] = index;
+            --_in_flight;
+
+            if (!_seekable) {
+                _queue_head = (_queue_head + 1) % _buffer_count;
+                if (--_queue_count != 0) {
+                    _write(_queue[_queue_head]);
+                }
+            }
+        }
+
+        // finish a buffer with blocking calls
+        void _complete(unsigned index) noexcept {
+            char const* data = buffer(index);
+            std::size_t const size = _sizes[index];
+            std::size_t written = _written[index];
+            while (written != size) {
+                ssize_t const result = _seekable ?
+                    ::pwrite(_fd, data + written, size - written, static_cast<off_t>(_offsets[index] + written)) :
+                    ::write(_fd, data + written, size - written);
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (result <= 0) {
+                    fail(result_code::io_error);
+                    return;
+                }
+                written += static_cast<std::size_t>(result);
+            }
+            _written[index] = written;
+        }
+
+        io_uring _ring = {};
+        std::unique_ptr<std::size_t[]> _sizes;
+        std::unique_ptr<std::size_t[]> _written;
+        std::unique_ptr<std::uint64_t[]> _offsets;
+        std::unique_ptr<unsigned[]> _queue;
+        unsigned _queue_head = 0;
+        unsigned _queue_count = 0;
+        std::uint64_t _offset = 0;
+        bool _seekable = false;
+        bool _initialized = false;
+    };
+#endif // defined(FORMATXX_USE_LIBURING)
+} // namespace
+
+namespace formatxx {
+    FORMATXX_PUBLIC result_code FORMATXX_API async_fd_writer::open(int fd, async_writer_options const& options) {
+        close();
+
+        if (options.buffer_size == 0 || options.buffer_count == 0) {
+            return result_code::out_of_range;
+        }
+
+#if defined(FORMATXX_USE_LIBURING)
+        _backend = uring_backend::create(fd, options).release();
+#endif
+        if (_backend == nullptr) {
+            _backend = new thread_backend(fd, options);
+        }
+
+        _block = options.block_when_full;
+        _dropped = 0;
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API async_fd_writer::close() noexcept {
+        if (_backend == nullptr) {
+            return result_code::success;
+        }
+
+        result_code const result = fence();
+
+        delete _backend;
+        _backend = nullptr;
+        _current = nullptr;
+        _used = _capacity = 0;
+        return result;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API async_fd_writer::flush() noexcept {
+        if (_current != nullptr && _used != 0) {
+            _submit();
+        }
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API async_fd_writer::fence() noexcept {
+        if (_backend == nullptr) {
+            return result_code::success;
+        }
+
+        flush();
+        _backend->fence();
+        return _backend->result();
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API async_fd_writer::result() const noexcept {
+        return _backend != nullptr ? _backend->result() : result_code::success;
+    }
+
+    FORMATXX_PUBLIC bool FORMATXX_API async_fd_writer::uses_io_uring() const noexcept {
+        return _backend != nullptr && _backend->uses_io_uring();
+    }
+
+    FORMATXX_PUBLIC bool FORMATXX_API async_fd_writer::_acquire() noexcept {
+        if (_backend == nullptr || !_backend->acquire(_index, _block)) {
+            return false;
+        }
+
+        _current = _backend->buffer(_index);
+        _capacity = _backend->buffer_size();
+        _used = 0;
+        return true;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API async_fd_writer::_submit() noexcept {
+        _backend->submit(_index, _used);
+        _current = nullptr;
+        _used = _capacity = 0;
+    }
+} // namespace formatxx
@@ -0,0 +1,410 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/binlog.h>
+#include <formatxx/allocation_tracking.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/// Open-addressed table of interned format strings, keyed by address and length.
+///
+/// Each entry keeps a copy of its text, compared on every lookup, so a buffer reused for a
+/// different format string at the same address is not mistaken for the earlier one.
+struct formatxx::_detail::binlog_dictionary {
+    struct entry {
+        char const* data = nullptr;
+        std::size_t size = 0;
+        std::uint64_t id = 0;
+        char* text = nullptr;
+    };
+
+    explicit binlog_dictionary(std::size_t capacity) : capacity(capacity) {
+        std::size_t slots = 16;
+        while (slots < capacity * 2) {
+            slots <<= 1;
+        }
+        entries = new entry[slots];
+        mask = slots - 1;
+        FORMATXX_TRACK_ALLOCATION(slots * sizeof(entry));
+    }
+    ~binlog_dictionary() {
+        for (std::size_t index = 0; index <= mask; ++index) {
+            delete[] entries[index].text;
+        }
+        delete[] entries;
+    }
+
+    /// The entry for a format string, or the empty entry where it should be added.
+    entry* find(string_view format) noexcept {
+        std::uintptr_t hash = reinterpret_cast<std::uintptr_t>(format.data()) ^ format.size();
+        hash ^= hash >> 17;
+        hash *= 0x9E3779B97F4A7C15ULL & ~std::uintptr_t(0);
+        for (std::size_t index = hash & mask;; index = (index + 1) & mask) {
+            entry& candidate = entries[index];
+            if (candidate.data == nullptr) {
+                return &candidate;
+            }
+            if (candidate.data == format.data() && candidate.size == format.size() && std::memcmp(candidate.text, format.data(), format.size()) == 0) {
+                return &candidate;
+            }
+        }
+    }
+
+    void add(entry& slot, string_view format, std::uint64_t id) {
+        slot.text = new char[format.size() + 1];
+        FORMATXX_TRACK_ALLOCATION(format.size() + 1);
+        std::memcpy(slot.text, format.data(), format.size());
+        slot.data = format.data();
+        slot.size = format.size();
+        slot.id = id;
+    }
+
+    entry* entries = nullptr;
+    std::size_t mask = 0;
+    std::size_t capacity = 0;
+};
+
+namespace {
+    using namespace formatxx;
+    using formatxx::_detail::format_arg_type;
+
+    class binlog_reader {
+    public:
+        explicit binlog_reader(string_view input) noexcept : _cursor(input.data()), _end(input.data() + input.size()) {}
+
+        bool empty() const noexcept { return _cursor == _end; }
+        bool failed() const noexcept { return _failed; }
+        /// True if reading stopped at the end of the input rather than on a bad value.
+        bool truncated() const noexcept { return _truncated; }
+        char const* position() const noexcept { return _cursor; }
+
+        std::uint8_t byte() noexcept {
+            if (_cursor == _end) {
+                _failed = _truncated = true;
+                return 0;
+            }
+            return static_cast<std::uint8_t>(*_cursor++);
+        }
+
+        std::uint64_t varint() noexcept {
+            std::uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                std::uint8_t const next = byte();
+                value |= std::uint64_t(next & 0x7f) << shift;
+                if ((next & 0x80) == 0) {
+                    return value;
+                }
+            }
+            _failed = true;
+            return 0;
+        }
+
+        std::int64_t zigzag() noexcept {
+            std::uint64_t const value = varint();
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+
+        std::uint64_t fixed(unsigned size) noexcept {
+            std::uint64_t value = 0;
+            for (unsigned index = 0; index != size; ++index) {
+                value |= std::uint64_t(byte()) << (index * 8);
+            }
+            return value;
+        }
+
+        string_view bytes(std::uint64_t size) noexcept {
+            if (size > static_cast<std::uint64_t>(_end - _cursor)) {
+                _failed = _truncated = true;
+                _cursor = _end;
+                return {};
+            }
+            string_view const result(_cursor, static_cast<std::size_t>(size));
+            _cursor += size;
+            return result;
+        }
+
+    private:
+        char const* _cursor = nullptr;
+        char const* _end = nullptr;
+        bool _failed = false;
+        bool _truncated = false;
+    };
+
+    /// Storage for one decoded scalar, suitably aligned for any of them.
+    union binlog_value {
+        char c;
+        wchar_t w;
+        signed char sc;
+        unsigned char uc;
+        signed int si;
+        unsigned int ui;
+        signed short ss;
+        unsigned short us;
+        signed long sl;
+        unsigned long ul;
+        signed long long sll;
+        unsigned long long ull;
+        float f;
+        double d;
+        bool b;
+        void const* p;
+    };
+}
+
+/// Formats known to a decoder, plus scratch space reused across records.
+struct formatxx::binlog_decoder::state {
+    struct definition {
+        std::string text;
+        _detail::record_style style = _detail::record_style::format;
+    };
+
+    result_code header(binlog_reader& reader) noexcept;
+    result_code entry(binlog_reader& reader, format_writer& out, string_view separator);
+
+    std::vector<definition> formats;
+    std::string narrow[max_record_args];
+    std::wstring wide[max_record_args];
+    /// start of an entry continued by the next call to feed()
+    std::string pending;
+    bool started = false;
+};
+
+formatxx::result_code formatxx::binlog_decoder::state::header(binlog_reader& reader) noexcept {
+    string_view const header = reader.bytes(_detail::binlog_header_size);
+    if (reader.failed() || std::memcmp(header.data(), _detail::binlog_magic, sizeof(_detail::binlog_magic)) != 0) {
+        return result_code::malformed_input;
+    }
+    if (static_cast<std::uint8_t>(header.data()[4]) != binlog_version) {
+        return result_code::malformed_input;
+    }
+
+    started = true;
+    return result_code::success;
+}
+
+/// Decode one entry; nothing is written or defined unless the whole entry was read.
+formatxx::result_code formatxx::binlog_decoder::state::entry(binlog_reader& reader, format_writer& out, string_view separator) {
+    auto const tag = static_cast<_detail::binlog_entry>(reader.byte());
+
+    if (tag == _detail::binlog_entry::define) {
+        std::uint64_t const id = reader.varint();
+        auto const style = static_cast<_detail::record_style>(reader.byte());
+        string_view const text = reader.bytes(reader.varint());
+        if (reader.failed() || id > formats.size() || (style != _detail::record_style::format && style != _detail::record_style::printf)) {
+            return result_code::malformed_input;
+        }
+
+        if (id == formats.size()) {
+            formats.emplace_back();
+        }
+        state::definition& definition = formats[static_cast<std::size_t>(id)];
+        definition.text.assign(text.data(), text.size());
+        definition.style = style;
+        return result_code::success;
+    }
+
+    if (tag != _detail::binlog_entry::record) {
+        return result_code::malformed_input;
+    }
+
+    std::uint64_t const id = reader.varint();
+    std::size_t const count = reader.byte();
+    if (reader.failed() || id >= formats.size() || count > max_record_args) {
+        return result_code::malformed_input;
+    }
+
+    binlog_value values[max_record_args];
+    void const* strings[max_record_args];
+    _detail::basic_format_arg<char> args[max_record_args];
+
+    for (std::size_t index = 0; index != count; ++index) {
+        auto const type = static_cast<format_arg_type>(reader.byte());
+        binlog_value& value = values[index];
+        void const* payload = &value;
+
+        switch (type) {
+        case format_arg_type::char_t: value.c = static_cast<char>(reader.varint()); break;
+        case format_arg_type::wchar: value.w = static_cast<wchar_t>(reader.varint()); break;
+        case format_arg_type::signed_char: value.sc = static_cast<signed char>(reader.zigzag()); break;
+        case format_arg_type::unsigned_char: value.uc = static_cast<unsigned char>(reader.varint()); break;
+        case format_arg_type::signed_int: value.si = static_cast<signed int>(reader.zigzag()); break;
+        case format_arg_type::unsigned_int: value.ui = static_cast<unsigned int>(reader.varint()); break;
+        case format_arg_type::signed_short_int: value.ss = static_cast<signed short>(reader.zigzag()); break;
+        case format_arg_type::unsigned_short_int: value.us = static_cast<unsigned short>(reader.varint()); break;
+        case format_arg_type::signed_long_int: value.sl = static_cast<signed long>(reader.zigzag()); break;
+        case format_arg_type::unsigned_long_int: value.ul = static_cast<unsigned long>(reader.varint()); break;
+        case format_arg_type::signed_long_long_int: value.sll = static_cast<signed long long>(reader.zigzag()); break;
+        case format_arg_type::unsigned_long_long_int: value.ull = static_cast<unsigned long long>(reader.varint()); break;
+        case format_arg_type::single_float: {
+            std::uint32_t const bits = static_cast<std::uint32_t>(reader.fixed(4));
+            std::memcpy(&value.f, &bits, sizeof(bits));
+            break;
+        }
+        case format_arg_type::double_float: {
+            std::uint64_t const bits = reader.fixed(8);
+            std::memcpy(&value.d, &bits, sizeof(bits));
+            break;
+        }
+        case format_arg_type::boolean: value.b = reader.byte() != 0; break;
+        case format_arg_type::null_pointer: payload = nullptr; break;
+        case format_arg_type::void_pointer: value.p = reinterpret_cast<void const*>(static_cast<std::uintptr_t>(reader.varint())); break;
+        case format_arg_type::char_string: {
+            string_view const text = reader.bytes(reader.varint());
+            narrow[index].assign(text.data(), text.size());
+            strings[index] = narrow[index].c_str();
+            payload = &strings[index];
+            break;
+        }
+        case format_arg_type::wchar_string: {
+            std::uint64_t const length = reader.varint();
+            std::wstring& text = wide[index];
+            text.clear();
+            for (std::uint64_t character = 0; character != length && !reader.failed(); ++character) {
+                text.push_back(static_cast<wchar_t>(reader.varint()));
+            }
+            strings[index] = text.c_str();
+            payload = &strings[index];
+            break;
+        }
+        default:
+            return result_code::malformed_input;
+        }
+
+        if (reader.failed()) {
+            return result_code::malformed_input;
+        }
+        args[index] = _detail::basic_format_arg<char>(type, payload);
+    }
+
+    state::definition const& definition = formats[static_cast<std::size_t>(id)];
+    string_view const format(definition.text.data(), definition.text.size());
+    _detail::basic_format_arg_list<char> const list(args, count);
+    if (definition.style == _detail::record_style::printf) {
+        _detail::printf_impl(out, format, list);
+    }
+    else {
+        _detail::format_impl(out, format, list);
+    }
+    out.write(separator);
+    return result_code::success;
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC FORMATXX_API binlog_writer::binlog_writer(format_writer& sink, std::size_t dictionary_capacity) : _sink(sink), _dictionary(new _detail::binlog_dictionary(dictionary_capacity)) {
+        char const header[_detail::binlog_header_size] = {
+            _detail::binlog_magic[0], _detail::binlog_magic[1], _detail::binlog_magic[2], _detail::binlog_magic[3],
+            static_cast<char>(binlog_version), 0, 0, 0
+        };
+        _sink.write(string_view(header, sizeof(header)));
+    }
+
+    FORMATXX_PUBLIC FORMATXX_API binlog_writer::~binlog_writer() {
+        delete _dictionary;
+    }
+
+    FORMATXX_PUBLIC bool FORMATXX_API binlog_writer::_intern(string_view format, _detail::record_style style, std::uint64_t& id) {
+        _detail::binlog_dictionary::entry* const entry = _dictionary->find(format);
+        if (entry->data != nullptr) {
+            id = entry->id;
+            return true;
+        }
+        if (_next_id == _dictionary->capacity) {
+            return false;
+        }
+
+        id = _next_id++;
+        _dictionary->add(*entry, format, id);
+
+        _detail::binlog_encoder encoder(_sink);
+        encoder.byte(static_cast<std::uint8_t>(_detail::binlog_entry::define));
+        encoder.varint(id);
+        encoder.byte(static_cast<std::uint8_t>(style));
+        encoder.varint(format.size());
+        encoder.bytes(format.data(), format.size());
+        return true;
+    }
+
+    FORMATXX_PUBLIC FORMATXX_API binlog_decoder::binlog_decoder() : _state(new state) {}
+
+    FORMATXX_PUBLIC FORMATXX_API binlog_decoder::~binlog_decoder() {
+        delete _state;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API binlog_decoder::decode(string_view log, format_writer& out, string_view separator) {
+        finish();
+
+        result_code const result = feed(log, out, separator);
+        return result != result_code::success ? result : finish();
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API binlog_decoder::feed(string_view input, format_writer& out, string_view separator) {
+        std::string& pending = _state->pending;
+        bool const buffered = !pending.empty();
+        if (buffered) {
+            pending.append(input.data(), input.size());
+            input = string_view(pending.data(), pending.size());
+        }
+
+        binlog_reader reader(input);
+        char const* consumed = input.data();
+        result_code result = result_code::success;
+        while (!reader.empty()) {
+            result = _state->started ? _state->entry(reader, out, separator) : _state->header(reader);
+            if (result != result_code::success) {
+                break;
+            }
+            consumed = reader.position();
+        }
+
+        if (result != result_code::success && !reader.truncated()) {
+            return result;
+        }
+
+        // keep the start of an entry that continues in the next input
+        std::size_t const used = static_cast<std::size_t>(consumed - input.data());
+        if (buffered) {
+            pending.erase(0, used);
+        }
+        else {
+            pending.assign(consumed, input.size() - used);
+        }
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API binlog_decoder::finish() noexcept {
+        bool const complete = _state->started && _state->pending.empty();
+
+        _state->formats.clear();
+        _state->pending.clear();
+        _state->started = false;
+        return complete ? result_code::success : result_code::malformed_input;
+    }
+} // namespace formatxx
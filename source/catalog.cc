@@ -0,0 +1,286 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#include <formatxx/catalog.h>
+#include <formatxx/allocation_tracking.h>
+
+#include <formatxx/_detail/format_traits.h>
+#include <formatxx/_detail/format_impl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+#if !defined(_WIN32)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace {
+    /// A template parsed into the steps format_impl would take through it.
+    struct compiled_template {
+        std::size_t count = 0;
+        formatxx::_detail::format_step<char>* steps = nullptr;
+
+        ~compiled_template() { delete[] steps; }
+    };
+
+    compiled_template* compile(formatxx::string_view text) {
+        using formatxx::_detail::format_step;
+        using formatxx::_detail::parse_format_step;
+
+        char const* const begin = text.data();
+        char const* const end = begin + text.size();
+
+        format_step<char> step;
+        std::size_t count = 0;
+        unsigned next_index = 0;
+        for (char const* iter = begin; iter < end; ++count) {
+            iter = parse_format_step(iter, end, next_index, step);
+        }
+
+        auto* const compiled = new compiled_template;
+        compiled->steps = new format_step<char>[count];
+        compiled->count = count;
+        FORMATXX_TRACK_ALLOCATION(sizeof(compiled_template) + sizeof(format_step<char>) * count);
+
+        next_index = 0;
+        char const* iter = begin;
+        for (std::size_t index = 0; index != count; ++index) {
+            iter = parse_format_step(iter, end, next_index, compiled->steps[index]);
+        }
+
+        return compiled;
+    }
+
+    bool id_less(formatxx::string_view lhs, formatxx::string_view rhs) noexcept {
+        std::size_t const length = lhs.size() < rhs.size() ? lhs.size() : rhs.size();
+        int const order = length != 0 ? std::memcmp(lhs.data(), rhs.data(), length) : 0;
+        return order < 0 || (order == 0 && lhs.size() < rhs.size());
+    }
+
+    bool is_space(char ch) noexcept {
+        return ch == ' ' || ch == '\t';
+    }
+}
+
+struct formatxx::format_catalog::entry {
+    entry() noexcept = default;
+
+    // entries are only copied while the index is sorted, before any is compiled
+    entry(entry const& rhs) noexcept : id(rhs.id), text(rhs.text), compiled(rhs.compiled.load(std::memory_order_relaxed)) {}
+    entry& operator=(entry const& rhs) noexcept {
+        id = rhs.id;
+        text = rhs.text;
+        compiled.store(rhs.compiled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    string_view id;
+    string_view text;
+    mutable std::atomic<compiled_template*> compiled = nullptr;
+};
+
+namespace formatxx {
+    FORMATXX_PUBLIC FORMATXX_API format_catalog::~format_catalog() {
+        close();
+    }
+
+#if !defined(_WIN32)
+    FORMATXX_PUBLIC result_code FORMATXX_API format_catalog::open(char const* path) noexcept {
+        close();
+
+        int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            return result_code::io_error;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            return result_code::io_error;
+        }
+
+        std::size_t const size = static_cast<std::size_t>(info.st_size);
+        if (size != 0) {
+            void* const memory = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (memory == MAP_FAILED) {
+                ::close(fd);
+                return result_code::io_error;
+            }
+
+            _mapping = memory;
+            _mapping_size = size;
+        }
+        ::close(fd);
+
+        return _index({ static_cast<char const*>(_mapping), _mapping_size });
+    }
+#else
+    FORMATXX_PUBLIC result_code FORMATXX_API format_catalog::open(char const*) noexcept {
+        close();
+        return result_code::io_error;
+    }
+#endif
+
+    FORMATXX_PUBLIC result_code FORMATXX_API format_catalog::assign(string_view contents) noexcept {
+        close();
+        return _index(contents);
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API format_catalog::close() noexcept {
+        for (std::size_t index = 0; index != _count; ++index) {
+            delete _entries[index].compiled.load(std::memory_order_acquire);
+        }
+        delete[] _entries;
+        _entries = nullptr;
+        _count = 0;
+
+#if !defined(_WIN32)
+        if (_mapping != nullptr) {
+            ::munmap(_mapping, _mapping_size);
+        }
+#endif
+        _mapping = nullptr;
+        _mapping_size = 0;
+    }
+
+    FORMATXX_PUBLIC std::size_t FORMATXX_API format_catalog::find(string_view id) const noexcept {
+        entry const* const end = _entries + _count;
+        entry const* const found = std::lower_bound(static_cast<entry const*>(_entries), end, id, [](entry const& lhs, string_view rhs) { return id_less(lhs.id, rhs); });
+        return found != end && found->id == id ? static_cast<std::size_t>(found - _entries) : npos;
+    }
+
+    FORMATXX_PUBLIC string_view FORMATXX_API format_catalog::id(std::size_t index) const noexcept {
+        return index < _count ? _entries[index].id : string_view();
+    }
+
+    FORMATXX_PUBLIC string_view FORMATXX_API format_catalog::text(std::size_t index) const noexcept {
+        return index < _count ? _entries[index].text : string_view();
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API format_catalog::_render(format_writer& writer, std::size_t index, _detail::basic_format_arg_list<char> args) const {
+        if (index >= _count) {
+            return result_code::out_of_range;
+        }
+
+        entry const& found = _entries[index];
+
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+        _detail::tracked_format_scope const tracking_scope(found.text.data(), found.text.size());
+#endif
+
+        compiled_template* compiled = found.compiled.load(std::memory_order_acquire);
+        if (compiled == nullptr) {
+            // threads racing to compile the same template each build it; the first published copy wins
+            compiled_template* const built = compile(found.text);
+            if (found.compiled.compare_exchange_strong(compiled, built, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                compiled = built;
+            }
+            else {
+                delete built;
+            }
+        }
+
+        result_code result = result_code::success;
+        for (std::size_t step = 0; step != compiled->count; ++step) {
+            result_code const step_result = _detail::write_format_step(writer, compiled->steps[step], args);
+            if (step_result != result_code::success) {
+                result = step_result;
+            }
+        }
+        return result;
+    }
+
+    result_code format_catalog::_index(string_view contents) noexcept {
+        char const* const begin = contents.data();
+        char const* const end = begin + contents.size();
+
+        // every entry takes a line, so the line count bounds the index size
+        std::size_t lines = 1;
+        for (char const* iter = begin; iter != end; ++iter) {
+            lines += *iter == '\n';
+        }
+
+        _entries = new (std::nothrow) entry[lines];
+        if (_entries == nullptr) {
+            return result_code::out_of_space;
+        }
+        FORMATXX_TRACK_ALLOCATION(sizeof(entry) * lines);
+
+        for (char const* line = begin; line < end;) {
+            char const* line_end = static_cast<char const*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+            char const* const next = line_end != nullptr ? line_end + 1 : end;
+            if (line_end == nullptr) {
+                line_end = end;
+            }
+            if (line_end != line && line_end[-1] == '\r') {
+                --line_end;
+            }
+
+            char const* const separator = static_cast<char const*>(std::memchr(line, '=', static_cast<std::size_t>(line_end - line)));
+            if (line != line_end && *line != '#' && separator != nullptr) {
+                char const* id_begin = line;
+                char const* id_end = separator;
+                while (id_begin != id_end && is_space(*id_begin)) {
+                    ++id_begin;
+                }
+                while (id_end != id_begin && is_space(id_end[-1])) {
+                    --id_end;
+                }
+
+                // blanks after the separator are dropped like those around the id; the rest is verbatim
+                char const* text_begin = separator + 1;
+                while (text_begin != line_end && is_space(*text_begin)) {
+                    ++text_begin;
+                }
+
+                if (id_begin != id_end) {
+                    entry& added = _entries[_count++];
+                    added.id = { id_begin, id_end };
+                    added.text = { text_begin, line_end };
+                }
+            }
+
+            line = next;
+        }
+
+        // on duplicate ids the first in the file is found
+        std::sort(_entries, _entries + _count, [](entry const& lhs, entry const& rhs) {
+            return id_less(lhs.id, rhs.id) || (!id_less(rhs.id, lhs.id) && lhs.id.data() < rhs.id.data());
+        });
+
+        return result_code::success;
+    }
+}
@@ -0,0 +1,247 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#include <formatxx/csv_writer.h>
+
+#include <formatxx/_detail/format_traits.h>
+#include <formatxx/_detail/write_float.h>
+#include <formatxx/_detail/write_integer.h>
+#include <formatxx/_detail/write_string.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    /// Collects output into large blocks before passing it on.
+    class block_writer final : public formatxx::format_writer {
+    public:
+        explicit block_writer(formatxx::format_writer& out) noexcept : _out(out) {}
+
+        void write(formatxx::string_view str) override {
+            if (str.empty()) {
+                return;
+            }
+            if (str.size() > sizeof(_buffer) - _size) {
+                flush();
+                if (str.size() >= sizeof(_buffer)) {
+                    _out.write(str);
+                    return;
+                }
+            }
+
+            std::memcpy(_buffer + _size, str.data(), str.size());
+            _size += str.size();
+        }
+
+        void put(char ch) {
+            if (_size == sizeof(_buffer)) {
+                flush();
+            }
+            _buffer[_size++] = ch;
+        }
+
+        void flush() {
+            if (_size != 0) {
+                _out.write({ _buffer, _size });
+                _size = 0;
+            }
+        }
+
+    private:
+        formatxx::format_writer& _out;
+        std::size_t _size = 0;
+        char _buffer[formatxx::csv_exporter::block_size];
+    };
+
+    constexpr std::uint64_t byte_ones = 0x0101010101010101ull;
+    constexpr std::uint64_t byte_highs = 0x8080808080808080ull;
+
+    /// True if any byte of word equals the byte repeated in pattern.
+    constexpr bool has_byte(std::uint64_t word, std::uint64_t pattern) noexcept {
+        std::uint64_t const diff = word ^ pattern;
+        return ((diff - byte_ones) & ~diff & byte_highs) != 0;
+    }
+
+    /// True if a field contains the delimiter, a quote, or a line break. Checks eight bytes at a time.
+    bool needs_quoting(formatxx::string_view str, char delimiter) noexcept {
+        std::uint64_t const delimiters = byte_ones * static_cast<unsigned char>(delimiter);
+        std::uint64_t const quotes = byte_ones * static_cast<unsigned char>('"');
+        std::uint64_t const returns = byte_ones * static_cast<unsigned char>('\r');
+        std::uint64_t const newlines = byte_ones * static_cast<unsigned char>('\n');
+
+        char const* const data = str.data();
+        std::size_t const size = str.size();
+        std::size_t index = 0;
+
+        for (; index + sizeof(std::uint64_t) <= size; index += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, data + index, sizeof(word));
+            if (has_byte(word, delimiters) | has_byte(word, quotes) | has_byte(word, returns) | has_byte(word, newlines)) {
+                return true;
+            }
+        }
+
+        for (; index != size; ++index) {
+            char const ch = data[index];
+            if (ch == delimiter || ch == '"' || ch == '\r' || ch == '\n') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void write_field(block_writer& out, formatxx::string_view str, formatxx::format_options const& options, char delimiter) {
+        if (!needs_quoting(str, delimiter)) {
+            formatxx::_detail::write_string(out, str, options);
+            return;
+        }
+
+        // quoted fields are written without padding, which would only confuse readers
+        if (options.precision != ~0u) {
+            str = formatxx::_detail::trim_string(str, options.precision);
+        }
+
+        out.put('"');
+        char const* begin = str.data();
+        char const* const end = begin + str.size();
+        for (char const* iter = begin; iter != end; ++iter) {
+            if (*iter == '"') {
+                out.write({ begin, iter + 1 });
+                begin = iter; // the quote is written again as the start of the next run
+            }
+        }
+        out.write({ begin, end });
+        out.put('"');
+    }
+
+    using cell_writer = void(*)(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk string_at, std::size_t row, formatxx::format_options const& options, char delimiter);
+
+    template <typename T>
+    void write_integer_cell(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk, std::size_t row, formatxx::format_options const& options, char) {
+        formatxx::_detail::write_integer(out, static_cast<T const*>(values)[row], options);
+    }
+
+    template <typename T>
+    void write_float_cell(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk, std::size_t row, formatxx::format_options const& options, char) {
+        formatxx::_detail::write_float(out, static_cast<double>(static_cast<T const*>(values)[row]), options);
+    }
+
+    void write_bool_cell(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk, std::size_t row, formatxx::format_options const& options, char) {
+        using traits = formatxx::_detail::FormatTraits<char>;
+        formatxx::_detail::write_string(out, static_cast<bool const*>(values)[row] ? traits::sTrue : traits::sFalse, options);
+    }
+
+    void write_char_cell(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk, std::size_t row, formatxx::format_options const& options, char delimiter) {
+        write_field(out, { static_cast<char const*>(values) + row, 1 }, options, delimiter);
+    }
+
+    void write_c_string_cell(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk, std::size_t row, formatxx::format_options const& options, char delimiter) {
+        char const* const value = static_cast<char const* const*>(values)[row];
+        write_field(out, value != nullptr ? formatxx::string_view(value) : formatxx::string_view(), options, delimiter);
+    }
+
+    void write_string_cell(block_writer& out, void const* values, formatxx::_detail::csv_string_thunk string_at, std::size_t row, formatxx::format_options const& options, char delimiter) {
+        write_field(out, string_at(values, row), options, delimiter);
+    }
+
+    cell_writer resolve_cell_writer(formatxx::_detail::format_arg_type type) noexcept {
+        using formatxx::_detail::format_arg_type;
+
+        switch (type) {
+        case format_arg_type::char_t: return &write_char_cell;
+        case format_arg_type::signed_char: return &write_integer_cell<signed char>;
+        case format_arg_type::unsigned_char: return &write_integer_cell<unsigned char>;
+        case format_arg_type::signed_int: return &write_integer_cell<signed int>;
+        case format_arg_type::unsigned_int: return &write_integer_cell<unsigned int>;
+        case format_arg_type::signed_short_int: return &write_integer_cell<signed short>;
+        case format_arg_type::unsigned_short_int: return &write_integer_cell<unsigned short>;
+        case format_arg_type::signed_long_int: return &write_integer_cell<signed long>;
+        case format_arg_type::unsigned_long_int: return &write_integer_cell<unsigned long>;
+        case format_arg_type::signed_long_long_int: return &write_integer_cell<signed long long>;
+        case format_arg_type::unsigned_long_long_int: return &write_integer_cell<unsigned long long>;
+        case format_arg_type::single_float: return &write_float_cell<float>;
+        case format_arg_type::double_float: return &write_float_cell<double>;
+        case format_arg_type::boolean: return &write_bool_cell;
+        case format_arg_type::char_string: return &write_c_string_cell;
+        case format_arg_type::custom: return &write_string_cell;
+        default: return nullptr;
+        }
+    }
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC result_code FORMATXX_API csv_exporter::_add(column const& added, std::size_t count) noexcept {
+        if (_column_count == max_columns || (_column_count != 0 && count != _rows)) {
+            return result_code::out_of_range;
+        }
+        if (resolve_cell_writer(added.type) == nullptr) {
+            return result_code::malformed_input;
+        }
+
+        _columns[_column_count++] = added;
+        _rows = count;
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API csv_exporter::write(format_writer& out) const {
+        cell_writer writers[max_columns];
+        for (std::size_t index = 0; index != _column_count; ++index) {
+            writers[index] = resolve_cell_writer(_columns[index].type);
+        }
+
+        block_writer block(out);
+
+        if (_options.header && _column_count != 0) {
+            for (std::size_t index = 0; index != _column_count; ++index) {
+                if (index != 0) {
+                    block.put(_options.delimiter);
+                }
+                write_field(block, _columns[index].name, {}, _options.delimiter);
+            }
+            block.write(_options.line_end);
+        }
+
+        for (std::size_t row = 0; row != _rows; ++row) {
+            for (std::size_t index = 0; index != _column_count; ++index) {
+                if (index != 0) {
+                    block.put(_options.delimiter);
+                }
+
+                column const& current = _columns[index];
+                writers[index](block, current.values, current.string_at, row, current.options, _options.delimiter);
+            }
+            block.write(_options.line_end);
+        }
+
+        block.flush();
+        return result_code::success;
+    }
+}
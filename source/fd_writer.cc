@@ -0,0 +1,132 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/writers.h>
+#include <cstddef>
+
+#if defined(_WIN32)
+#   include <io.h>
+#   include <climits>
+#else
+#   include <sys/uio.h>
+#   include <unistd.h>
+#   include <cerrno>
+#   include <climits>
+#endif
+
+namespace {
+#if defined(PIPE_BUF)
+    constexpr std::size_t console_buffer_size = PIPE_BUF;
+#else
+    constexpr std::size_t console_buffer_size = 4096;
+#endif
+
+    // the buffer outlives the writer, whose destructor flushes at thread exit
+    struct console_stream {
+        explicit console_stream(int fd) noexcept : writer(fd, buffer, formatxx::fd_flush::newline) {}
+
+        char buffer[console_buffer_size];
+        formatxx::fd_writer writer;
+    };
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC result_code FORMATXX_API _detail::write_fd(int fd, void const* data, std::size_t size) noexcept {
+        char const* ptr = static_cast<char const*>(data);
+
+        while (size != 0) {
+#if defined(_WIN32)
+            unsigned const count = size > INT_MAX ? INT_MAX : static_cast<unsigned>(size);
+            int const written = ::_write(fd, ptr, count);
+#else
+            ssize_t const written = ::write(fd, ptr, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+#endif
+            if (written <= 0) {
+                return result_code::io_error;
+            }
+
+            ptr += written;
+            size -= static_cast<std::size_t>(written);
+        }
+
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API _detail::write_fd_spans(int fd, io_span* spans, std::size_t count) noexcept {
+#if defined(_WIN32)
+        for (std::size_t index = 0; index != count; ++index) {
+            result_code const result = write_fd(fd, spans[index].data, spans[index].size);
+            if (result != result_code::success) {
+                return result;
+            }
+        }
+        return result_code::success;
+#else
+        static_assert(sizeof(io_span) == sizeof(iovec) && alignof(io_span) == alignof(iovec));
+        static_assert(offsetof(io_span, data) == offsetof(iovec, iov_base) && offsetof(io_span, size) == offsetof(iovec, iov_len));
+
+        while (count != 0) {
+            int const batch = count > IOV_MAX ? IOV_MAX : static_cast<int>(count);
+            ssize_t written = ::writev(fd, reinterpret_cast<iovec const*>(spans), batch);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return result_code::io_error;
+            }
+
+            // skip fully-written spans, then trim a partially-written one
+            while (count != 0 && static_cast<std::size_t>(written) >= spans->size) {
+                written -= static_cast<ssize_t>(spans->size);
+                ++spans;
+                --count;
+            }
+            if (written != 0) {
+                spans->data = static_cast<char const*>(spans->data) + written;
+                spans->size -= static_cast<std::size_t>(written);
+            }
+        }
+        return result_code::success;
+#endif
+    }
+
+    FORMATXX_PUBLIC fd_writer& FORMATXX_API stdout_writer() noexcept {
+        thread_local console_stream stream(1);
+        return stream.writer;
+    }
+
+    FORMATXX_PUBLIC fd_writer& FORMATXX_API stderr_writer() noexcept {
+        thread_local console_stream stream(2);
+        return stream.writer;
+    }
+} // namespace formatxx
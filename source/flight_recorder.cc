@@ -0,0 +1,179 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/flight_recorder.h>
+#include <formatxx/allocation_tracking.h>
+#include <cstring>
+
+namespace formatxx::_detail {
+    /// One slot of the ring. Text is stored through relaxed atomic words so that a dump
+    /// racing with recording threads is well defined; the stamp validates what was read.
+    struct alignas(flight_recorder::slot_size) flight_slot {
+        static constexpr std::size_t word_count = (flight_recorder::slot_size - 2 * sizeof(std::uint64_t)) / sizeof(std::uint64_t);
+        static constexpr std::size_t payload_size = word_count * sizeof(std::uint64_t);
+
+        /// 1 + position of the first slot of the record; 0 while being written
+        std::atomic<std::uint64_t> stamp = 0;
+        /// record length, meaningful in the first slot of a record
+        std::atomic<std::uint64_t> size = 0;
+        std::atomic<std::uint64_t> words[word_count] = {};
+    };
+
+    static_assert(sizeof(flight_slot) == flight_recorder::slot_size);
+}
+
+namespace {
+    using formatxx::_detail::flight_slot;
+
+    constexpr std::uint64_t slots_for(std::size_t size) noexcept {
+        return size == 0 ? 1 : (size + flight_slot::payload_size - 1) / flight_slot::payload_size;
+    }
+
+    void store_payload(flight_slot& slot, char const* text, std::size_t length) noexcept {
+        for (std::size_t word = 0; word != flight_slot::word_count && length != 0; ++word) {
+            std::size_t const count = length < sizeof(std::uint64_t) ? length : sizeof(std::uint64_t);
+            std::uint64_t value = 0;
+            std::memcpy(&value, text, count);
+            slot.words[word].store(value, std::memory_order_relaxed);
+            text += count;
+            length -= count;
+        }
+    }
+
+    void load_payload(flight_slot const& slot, char* text, std::size_t length) noexcept {
+        for (std::size_t word = 0; word != flight_slot::word_count && length != 0; ++word) {
+            std::size_t const count = length < sizeof(std::uint64_t) ? length : sizeof(std::uint64_t);
+            std::uint64_t const value = slot.words[word].load(std::memory_order_relaxed);
+            std::memcpy(text, &value, count);
+            text += count;
+            length -= count;
+        }
+    }
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC FORMATXX_API flight_recorder::flight_recorder(std::size_t capacity) {
+        // always room for at least one maximum-length record
+        std::uint64_t const minimum = slots_for(max_record_size);
+        _slot_count = (capacity + slot_size - 1) / slot_size;
+        if (_slot_count < minimum) {
+            _slot_count = minimum;
+        }
+
+        _slots = new flight_slot[_slot_count];
+        FORMATXX_TRACK_ALLOCATION(_slot_count * sizeof(flight_slot));
+    }
+
+    FORMATXX_PUBLIC FORMATXX_API flight_recorder::~flight_recorder() {
+        delete[] _slots;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API flight_recorder::record(string_view text) noexcept {
+        std::size_t const size = text.size() < max_record_size ? text.size() : max_record_size;
+        std::uint64_t const count = slots_for(size);
+        std::uint64_t const start = _head.fetch_add(count, std::memory_order_relaxed);
+
+        for (std::uint64_t index = 0; index != count; ++index) {
+            _slots[(start + index) % _slot_count].stamp.store(0, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        _slots[start % _slot_count].size.store(size, std::memory_order_relaxed);
+        for (std::uint64_t index = 0; index != count; ++index) {
+            std::size_t const offset = static_cast<std::size_t>(index) * flight_slot::payload_size;
+            std::size_t const length = size - offset < flight_slot::payload_size ? size - offset : flight_slot::payload_size;
+            store_payload(_slots[(start + index) % _slot_count], text.data() + offset, length);
+        }
+
+        for (std::uint64_t index = 0; index != count; ++index) {
+            _slots[(start + index) % _slot_count].stamp.store(start + 1, std::memory_order_release);
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API flight_recorder::dump(format_writer& out, string_view separator) const {
+        struct context_type {
+            format_writer& out;
+            string_view separator;
+        } context{ out, separator };
+
+        _visit([](void* context, string_view record) {
+            auto& state = *static_cast<context_type*>(context);
+            state.out.write(record);
+            state.out.write(state.separator);
+        }, &context);
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API flight_recorder::_visit(visit_thunk thunk, void* context) const noexcept {
+        char record[max_record_size];
+
+        std::uint64_t const head = _head.load(std::memory_order_acquire);
+        std::uint64_t position = head > _slot_count ? head - _slot_count : 0;
+
+        while (position < head) {
+            flight_slot const& first = _slots[position % _slot_count];
+            std::uint64_t const stamp = position + 1;
+
+            // skip continuation slots and records overwritten or still being written
+            if (first.stamp.load(std::memory_order_acquire) != stamp) {
+                ++position;
+                continue;
+            }
+
+            std::uint64_t size = first.size.load(std::memory_order_relaxed);
+            if (size > max_record_size) {
+                size = max_record_size;
+            }
+            std::uint64_t const count = slots_for(static_cast<std::size_t>(size));
+            if (position + count > head) {
+                break;
+            }
+
+            for (std::uint64_t index = 0; index != count; ++index) {
+                std::size_t const offset = static_cast<std::size_t>(index) * flight_slot::payload_size;
+                std::size_t const length = size - offset < flight_slot::payload_size ? static_cast<std::size_t>(size - offset) : flight_slot::payload_size;
+                load_payload(_slots[(position + index) % _slot_count], record + offset, length);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            bool intact = true;
+            for (std::uint64_t index = 0; index != count && intact; ++index) {
+                intact = _slots[(position + index) % _slot_count].stamp.load(std::memory_order_relaxed) == stamp;
+            }
+
+            if (!intact) {
+                ++position;
+                continue;
+            }
+
+            thunk(context, string_view(record, static_cast<std::size_t>(size)));
+            position += count;
+        }
+    }
+} // namespace formatxx
@@ -32,6 +32,7 @@
 
 #include <formatxx/_detail/format_arg_impl.h>
 #include <formatxx/_detail/format_impl.h>
+#include <formatxx/_detail/format_session_impl.h>
 #include <formatxx/_detail/parse_format.h>
 #include <formatxx/_detail/parse_printf.h>
 #include <formatxx/_detail/printf_impl.h>
@@ -59,10 +60,12 @@ namespace formatxx {
     template FORMATXX_PUBLIC result_code FORMATXX_API _detail::basic_format_arg<char>::format_into(basic_format_writer<char>& output, basic_format_options<char> const& options) const;
 	template FORMATXX_PUBLIC basic_parse_spec_result<char> FORMATXX_API parse_format_spec(basic_string_view<char> spec_string) noexcept;
     template FORMATXX_PUBLIC basic_parse_spec_result<char> FORMATXX_API parse_printf_spec(basic_string_view<char> spec_string) noexcept;
+    template FORMATXX_PUBLIC result_code FORMATXX_API _detail::format_session_state<char>::resume(char* buffer, std::size_t capacity, basic_format_arg_list<char> args);
 
     template FORMATXX_PUBLIC result_code FORMATXX_API _detail::format_impl(basic_format_writer<wchar_t>& out, basic_string_view<wchar_t> format, basic_format_arg_list<wchar_t> args);
     template FORMATXX_PUBLIC result_code FORMATXX_API _detail::printf_impl(basic_format_writer<wchar_t>& out, basic_string_view<wchar_t> format, basic_format_arg_list<wchar_t> args);
     template FORMATXX_PUBLIC result_code FORMATXX_API _detail::basic_format_arg<wchar_t>::format_into(basic_format_writer<wchar_t>& output, basic_format_options<wchar_t> const& options) const;
     template FORMATXX_PUBLIC basic_parse_spec_result<wchar_t> FORMATXX_API parse_format_spec(basic_string_view<wchar_t> spec_string) noexcept;
     template FORMATXX_PUBLIC basic_parse_spec_result<wchar_t> FORMATXX_API parse_printf_spec(basic_string_view<wchar_t> spec_string) noexcept;
+    template FORMATXX_PUBLIC result_code FORMATXX_API _detail::format_session_state<wchar_t>::resume(wchar_t* buffer, std::size_t capacity, basic_format_arg_list<wchar_t> args);
 } // namespace formatxx
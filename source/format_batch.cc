@@ -0,0 +1,227 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#include <formatxx/format_batch.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+    /// Shared progress of one run_batch call.
+    class batch_state {
+    public:
+        batch_state(std::size_t chunk_count, std::size_t slot_count, void* context, formatxx::_detail::batch_thunk format_chunk)
+            : _chunk_count(chunk_count), _slot_count(slot_count), _context(context), _format_chunk(format_chunk), _ready(new std::size_t[slot_count]()) {}
+
+        /// Claim and format chunks until none remain.
+        void work() noexcept {
+            for (;;) {
+                std::size_t const chunk = _next.fetch_add(1, std::memory_order_relaxed);
+                if (chunk >= _chunk_count) {
+                    return;
+                }
+
+                // the slot is reused once the chunk formatted into it before has been emitted
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _emitted_condition.wait(lock, [this, chunk] { return chunk < _emitted + _slot_count || _stopped; });
+                    if (_stopped) {
+                        return;
+                    }
+                }
+
+                _format(chunk);
+            }
+        }
+
+        /// Wait for the given chunk, formatting other chunks in the meantime when possible.
+        /// @returns false if the batch was stopped before the chunk was ready.
+        bool wait_for(std::size_t chunk, std::size_t& slot) noexcept {
+            slot = chunk % _slot_count;
+
+            for (;;) {
+                std::size_t next = _next.load(std::memory_order_relaxed);
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (_stopped) {
+                    return false;
+                }
+                if (_ready[slot] == chunk + 1) {
+                    return true;
+                }
+                if (_claimable(next, chunk)) {
+                    lock.unlock();
+                    if (_next.compare_exchange_weak(next, next + 1, std::memory_order_relaxed)) {
+                        _format(next);
+                    }
+                    continue;
+                }
+
+                // the chunk has been claimed by a worker, which will signal when it is done
+                _ready_condition.wait(lock, [this, slot, chunk] { return _ready[slot] == chunk + 1 || _stopped || _claimable(_next.load(std::memory_order_relaxed), chunk); });
+            }
+        }
+
+        /// Stop handing out chunks and wake every waiting thread.
+        void stop() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopped = true;
+            }
+            _ready_condition.notify_all();
+            _emitted_condition.notify_all();
+        }
+
+        /// Rethrow the first exception thrown while formatting, if any.
+        void rethrow() {
+            if (_error) {
+                std::rethrow_exception(_error);
+            }
+        }
+
+        void emitted(std::size_t chunk) noexcept {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _emitted = chunk + 1;
+            }
+            _emitted_condition.notify_all();
+        }
+
+    private:
+        bool _claimable(std::size_t next, std::size_t waiting) const noexcept {
+            return next < _chunk_count && next < waiting + _slot_count;
+        }
+
+        // an exception from a format_value overload or an allocation stops the batch; the
+        // calling thread rethrows it once every worker has been joined
+        void _format(std::size_t chunk) noexcept {
+            std::size_t const slot = chunk % _slot_count;
+            try {
+                _format_chunk(_context, chunk, slot);
+            }
+            catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (!_error) {
+                        _error = std::current_exception();
+                    }
+                }
+                stop();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _ready[slot] = chunk + 1;
+            }
+            _ready_condition.notify_all();
+        }
+
+        std::size_t const _chunk_count;
+        std::size_t const _slot_count;
+        void* const _context;
+        formatxx::_detail::batch_thunk const _format_chunk;
+
+        std::atomic<std::size_t> _next = 0;
+        std::mutex _mutex;
+        std::condition_variable _ready_condition;
+        std::condition_variable _emitted_condition;
+        std::size_t _emitted = 0;
+        std::unique_ptr<std::size_t[]> _ready;
+        bool _stopped = false;
+        std::exception_ptr _error;
+    };
+
+    /// Worker threads of one batch; stops the batch and joins them however run_batch exits.
+    class batch_workers {
+    public:
+        explicit batch_workers(batch_state& state) noexcept : _state(state) {}
+        ~batch_workers() {
+            _state.stop();
+            for (std::thread& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        batch_workers(batch_workers const&) = delete;
+        batch_workers& operator=(batch_workers const&) = delete;
+
+        void start(unsigned count) {
+            _workers.reserve(count);
+            for (unsigned index = 0; index != count; ++index) {
+                _workers.emplace_back([this] { _state.work(); });
+            }
+        }
+
+    private:
+        batch_state& _state;
+        std::vector<std::thread> _workers;
+    };
+}
+
+namespace formatxx::_detail {
+    FORMATXX_PUBLIC unsigned FORMATXX_API batch_thread_count(unsigned requested) noexcept {
+        if (requested != 0) {
+            return requested;
+        }
+
+        unsigned const hardware = std::thread::hardware_concurrency();
+        return hardware != 0 ? hardware : 1;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API run_batch(std::size_t chunk_count, std::size_t slot_count, unsigned threads, void* context, batch_thunk format_chunk, batch_thunk emit_chunk) {
+        if (threads <= 1 || slot_count <= 1) {
+            for (std::size_t chunk = 0; chunk != chunk_count; ++chunk) {
+                format_chunk(context, chunk, 0);
+                emit_chunk(context, chunk, 0);
+            }
+            return;
+        }
+
+        batch_state state(chunk_count, slot_count, context, format_chunk);
+        {
+            batch_workers workers(state);
+            workers.start(threads - 1);
+
+            // the caller formats too whenever the next chunk to emit is not ready yet
+            std::size_t slot = 0;
+            for (std::size_t chunk = 0; chunk != chunk_count && state.wait_for(chunk, slot); ++chunk) {
+                emit_chunk(context, chunk, slot);
+                state.emitted(chunk);
+            }
+        }
+        state.rethrow();
+    }
+}
@@ -0,0 +1,166 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/hash_writer.h>
+#include <cstring>
+
+// XXH64 by Yann Collet, https://github.com/Cyan4973/xxHash (BSD 2-Clause)
+
+namespace {
+    constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+    constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    constexpr std::uint64_t rotl(std::uint64_t value, unsigned bits) noexcept {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline std::uint64_t read64(unsigned char const* bytes) noexcept {
+        std::uint64_t value = 0;
+        for (unsigned index = 0; index != 8; ++index) {
+            value |= std::uint64_t(bytes[index]) << (index * 8);
+        }
+        return value;
+    }
+
+    inline std::uint32_t read32(unsigned char const* bytes) noexcept {
+        return std::uint32_t(bytes[0]) | std::uint32_t(bytes[1]) << 8 | std::uint32_t(bytes[2]) << 16 | std::uint32_t(bytes[3]) << 24;
+    }
+
+    constexpr std::uint64_t round(std::uint64_t lane, std::uint64_t input) noexcept {
+        return rotl(lane + input * prime2, 31) * prime1;
+    }
+
+    constexpr std::uint64_t merge_round(std::uint64_t hash, std::uint64_t lane) noexcept {
+        return (hash ^ round(0, lane)) * prime1 + prime4;
+    }
+
+    // the four lanes are independent, letting the CPU overlap their multiplies
+    inline unsigned char const* consume_stripes(std::uint64_t (&lanes)[4], unsigned char const* bytes, unsigned char const* end) noexcept {
+        std::uint64_t lane0 = lanes[0];
+        std::uint64_t lane1 = lanes[1];
+        std::uint64_t lane2 = lanes[2];
+        std::uint64_t lane3 = lanes[3];
+
+        while (end - bytes >= 32) {
+            lane0 = round(lane0, read64(bytes));
+            lane1 = round(lane1, read64(bytes + 8));
+            lane2 = round(lane2, read64(bytes + 16));
+            lane3 = round(lane3, read64(bytes + 24));
+            bytes += 32;
+        }
+
+        lanes[0] = lane0;
+        lanes[1] = lane1;
+        lanes[2] = lane2;
+        lanes[3] = lane3;
+        return bytes;
+    }
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC void FORMATXX_API _detail::xxh64_reset(xxh64_state& state, std::uint64_t seed) noexcept {
+        state.total = 0;
+        state.lanes[0] = seed + prime1 + prime2;
+        state.lanes[1] = seed + prime2;
+        state.lanes[2] = seed;
+        state.lanes[3] = seed - prime1;
+        state.pending_size = 0;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API _detail::xxh64_update(xxh64_state& state, void const* data, std::size_t size) noexcept {
+        unsigned char const* bytes = static_cast<unsigned char const*>(data);
+        unsigned char const* const end = bytes + size;
+        state.total += size;
+
+        if (state.pending_size + size < sizeof(state.pending)) {
+            if (size != 0) {
+                std::memcpy(state.pending + state.pending_size, bytes, size);
+            }
+            state.pending_size += static_cast<unsigned>(size);
+            return;
+        }
+
+        if (state.pending_size != 0) {
+            std::size_t const fill = sizeof(state.pending) - state.pending_size;
+            std::memcpy(state.pending + state.pending_size, bytes, fill);
+            consume_stripes(state.lanes, state.pending, state.pending + sizeof(state.pending));
+            bytes += fill;
+            state.pending_size = 0;
+        }
+
+        bytes = consume_stripes(state.lanes, bytes, end);
+
+        state.pending_size = static_cast<unsigned>(end - bytes);
+        if (state.pending_size != 0) {
+            std::memcpy(state.pending, bytes, state.pending_size);
+        }
+    }
+
+    FORMATXX_PUBLIC std::uint64_t FORMATXX_API _detail::xxh64_digest(xxh64_state const& state) noexcept {
+        std::uint64_t hash;
+        if (state.total >= 32) {
+            hash = rotl(state.lanes[0], 1) + rotl(state.lanes[1], 7) + rotl(state.lanes[2], 12) + rotl(state.lanes[3], 18);
+            hash = merge_round(hash, state.lanes[0]);
+            hash = merge_round(hash, state.lanes[1]);
+            hash = merge_round(hash, state.lanes[2]);
+            hash = merge_round(hash, state.lanes[3]);
+        }
+        else {
+            hash = state.lanes[2] /*seed*/ + prime5;
+        }
+        hash += state.total;
+
+        unsigned char const* bytes = state.pending;
+        unsigned char const* const end = bytes + state.pending_size;
+        for (; end - bytes >= 8; bytes += 8) {
+            hash ^= round(0, read64(bytes));
+            hash = rotl(hash, 27) * prime1 + prime4;
+        }
+        if (end - bytes >= 4) {
+            hash ^= std::uint64_t(read32(bytes)) * prime1;
+            hash = rotl(hash, 23) * prime2 + prime3;
+            bytes += 4;
+        }
+        for (; bytes != end; ++bytes) {
+            hash ^= *bytes * prime5;
+            hash = rotl(hash, 11) * prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+} // namespace formatxx
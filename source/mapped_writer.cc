@@ -0,0 +1,240 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/mapped_writer.h>
+
+#if !defined(_WIN32)
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+#if !defined(_WIN32)
+namespace {
+    /// Make the file at least offset + size bytes long, reserving the disk blocks where the
+    /// platform allows it, so a full disk is reported here rather than as SIGBUS on a store
+    /// into the mapping.
+    formatxx::result_code extend_file(int fd, std::uint64_t offset, std::size_t size) noexcept {
+#if !defined(__APPLE__)
+        int const error = ::posix_fallocate(fd, static_cast<off_t>(offset), static_cast<off_t>(size));
+        if (error == 0) {
+            return formatxx::result_code::success;
+        }
+        if (error == ENOSPC || error == EFBIG) {
+            return formatxx::result_code::out_of_space;
+        }
+        if (error != EINVAL && error != EOPNOTSUPP) {
+            return formatxx::result_code::io_error;
+        }
+        // the file system cannot reserve space; fall back to a sparse extension
+#endif
+        return ::ftruncate(fd, static_cast<off_t>(offset + size)) == 0 ? formatxx::result_code::success : formatxx::result_code::io_error;
+    }
+}
+#endif
+
+namespace formatxx {
+#if !defined(_WIN32)
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::open(char const* path, mapped_writer_options const& options) noexcept {
+        close();
+
+        span_writer path_writer(_path);
+        path_writer.write(path);
+        if (std::strlen(_path) != std::strlen(path)) {
+            _result = result_code::out_of_range;
+            return _result;
+        }
+
+        long const page_size = ::sysconf(_SC_PAGESIZE);
+        std::size_t const page = page_size > 0 ? static_cast<std::size_t>(page_size) : 4096;
+
+        _options = options;
+        _options.window_size = (options.window_size + page - 1) / page * page;
+        if (_options.window_size == 0) {
+            _options.window_size = page;
+        }
+        if (_options.max_file_size != 0 && _options.max_file_size < _options.window_size) {
+            _options.max_file_size = _options.window_size;
+        }
+
+        _file_index = 0;
+        _result = result_code::success;
+
+        result_code result = _open_file();
+        if (result == result_code::success) {
+            result = _map(0);
+            if (result != result_code::success) {
+                ::close(_fd);
+                _fd = -1;
+            }
+        }
+
+        _fail(result);
+        return result;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::close() noexcept {
+        if (_fd == -1) {
+            return _result;
+        }
+
+        _fail(_close_file());
+        return _result;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::sync() noexcept {
+        if (_window != nullptr && ::msync(_window, _end - _window, MS_SYNC) != 0) {
+            _fail(result_code::io_error);
+        }
+        return _result;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::_advance() noexcept {
+        std::uint64_t const next_offset = _window_offset + _options.window_size;
+
+        result_code result = _unmap();
+        if (result == result_code::success) {
+            if (_options.max_file_size != 0 && next_offset + _options.window_size > _options.max_file_size) {
+                result = _close_file();
+                ++_file_index;
+                if (result == result_code::success) {
+                    result = _open_file();
+                }
+                if (result == result_code::success) {
+                    result = _map(0);
+                }
+            }
+            else {
+                result = _map(next_offset);
+            }
+        }
+
+        _fail(result);
+        return result;
+    }
+
+    result_code mapped_file_writer::_map(std::uint64_t offset) noexcept {
+        std::size_t const size = _options.window_size;
+
+        result_code const extended = extend_file(_fd, offset, size);
+        if (extended != result_code::success) {
+            return extended;
+        }
+
+        void* const memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, static_cast<off_t>(offset));
+        if (memory == MAP_FAILED) {
+            return result_code::io_error;
+        }
+
+        if (_options.sequential) {
+            ::madvise(memory, size, MADV_SEQUENTIAL);
+        }
+
+        _window = _cursor = static_cast<char*>(memory);
+        _end = _window + size;
+        _window_offset = offset;
+        return result_code::success;
+    }
+
+    result_code mapped_file_writer::_unmap() noexcept {
+        if (_window == nullptr) {
+            return result_code::success;
+        }
+
+        result_code result = result_code::success;
+        std::size_t const size = _end - _window;
+
+        if (_options.sync != mapped_sync::none && ::msync(_window, size, _options.sync == mapped_sync::sync ? MS_SYNC : MS_ASYNC) != 0) {
+            result = result_code::io_error;
+        }
+        if (::munmap(_window, size) != 0) {
+            result = result_code::io_error;
+        }
+
+        // remember the written size of the file in case no further window is mapped
+        _window_offset += static_cast<std::uint64_t>(_cursor - _window);
+        _window = _cursor = _end = nullptr;
+        return result;
+    }
+
+    result_code mapped_file_writer::_open_file() noexcept {
+        char rolled_path[max_path_length + 16];
+        char const* path = _path;
+
+        if (_file_index != 0) {
+            span_writer writer(rolled_path);
+            format_to(writer, "{}.{}", _path, _file_index);
+            path = rolled_path;
+        }
+
+        // rolled files are replaced like the first one; see the class documentation
+        _fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        _window_offset = 0;
+        return _fd != -1 ? result_code::success : result_code::io_error;
+    }
+
+    result_code mapped_file_writer::_close_file() noexcept {
+        result_code result = _unmap();
+
+        if (::ftruncate(_fd, static_cast<off_t>(_window_offset)) != 0) {
+            result = result_code::io_error;
+        }
+        if (::close(_fd) != 0) {
+            result = result_code::io_error;
+        }
+
+        _fd = -1;
+        return result;
+    }
+#else
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::open(char const*, mapped_writer_options const&) noexcept {
+        return result_code::io_error;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::close() noexcept {
+        return _result;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::sync() noexcept {
+        return _result;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API mapped_file_writer::_advance() noexcept {
+        return result_code::io_error;
+    }
+#endif
+
+    void mapped_file_writer::_fail(result_code result) noexcept {
+        if (result != result_code::success && _result == result_code::success) {
+            _result = result;
+        }
+    }
+} // namespace formatxx
@@ -0,0 +1,311 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+#include <formatxx/shm_ring.h>
+#include <cstring>
+#include <new>
+
+#if !defined(_WIN32)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace {
+    using formatxx::_detail::shm_record_header;
+    using formatxx::_detail::shm_ring_header;
+
+    constexpr std::size_t header_size = (sizeof(shm_ring_header) + 63) / 64 * 64;
+
+    constexpr std::uint64_t footprint(std::uint64_t size) noexcept {
+        return (sizeof(shm_record_header) + size + 7) / 8 * 8;
+    }
+
+    shm_record_header& record_at(char* data, std::uint64_t offset) noexcept {
+        return *reinterpret_cast<shm_record_header*>(data + offset);
+    }
+
+    void mark_padding(char* data, std::uint64_t offset, std::uint64_t pad) noexcept {
+        shm_record_header& header = record_at(data, offset);
+        header.size = static_cast<std::uint32_t>(pad - sizeof(shm_record_header));
+        header.state.store(shm_record_header::padding, std::memory_order_release);
+    }
+}
+
+namespace formatxx {
+#if !defined(_WIN32)
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring::create(char const* name, std::size_t capacity) noexcept {
+        close();
+
+        std::uint64_t size = 4096;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        if (size > UINT32_MAX) {
+            return result_code::out_of_range;
+        }
+
+        ::shm_unlink(name);
+        int const fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd == -1) {
+            return result_code::io_error;
+        }
+
+        std::size_t const mapped_size = header_size + static_cast<std::size_t>(size);
+        void* memory = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(mapped_size)) == 0) {
+            memory = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (memory == MAP_FAILED) {
+            ::shm_unlink(name);
+            return result_code::io_error;
+        }
+
+        // the new object is zero-filled, which is the empty state of every record
+        _header = new (memory) shm_ring_header;
+        _header->capacity = size;
+        _header->version = shm_ring_header::version_value;
+        std::atomic_thread_fence(std::memory_order_release);
+        _header->magic = shm_ring_header::magic_value;
+
+        _data = static_cast<char*>(memory) + header_size;
+        _mapped_size = mapped_size;
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring::open(char const* name) noexcept {
+        close();
+
+        int const fd = ::shm_open(name, O_RDWR, 0);
+        if (fd == -1) {
+            return result_code::io_error;
+        }
+
+        struct stat info = {};
+        void* memory = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) > header_size) {
+            memory = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (memory == MAP_FAILED) {
+            return result_code::io_error;
+        }
+
+        auto* const header = static_cast<shm_ring_header*>(memory);
+        std::size_t const mapped_size = static_cast<std::size_t>(info.st_size);
+        if (header->magic != shm_ring_header::magic_value || header->version != shm_ring_header::version_value ||
+            header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0 || header_size + header->capacity != mapped_size) {
+            ::munmap(memory, mapped_size);
+            return result_code::malformed_input;
+        }
+
+        _header = header;
+        _data = static_cast<char*>(memory) + header_size;
+        _mapped_size = mapped_size;
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API shm_ring::close() noexcept {
+        if (_header != nullptr) {
+            ::munmap(_header, _mapped_size);
+        }
+        _header = nullptr;
+        _data = nullptr;
+        _mapped_size = 0;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring::unlink(char const* name) noexcept {
+        return ::shm_unlink(name) == 0 ? result_code::success : result_code::io_error;
+    }
+#else
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring::create(char const*, std::size_t) noexcept { return result_code::io_error; }
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring::open(char const*) noexcept { return result_code::io_error; }
+    FORMATXX_PUBLIC void FORMATXX_API shm_ring::close() noexcept {}
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring::unlink(char const*) noexcept { return result_code::io_error; }
+#endif
+
+    FORMATXX_PUBLIC void FORMATXX_API shm_ring_writer::_reserve(string_view str) noexcept {
+        shm_ring_header* const header = _ring.header();
+        if (header == nullptr || _overflow) {
+            _overflow = true;
+            return;
+        }
+
+        std::uint64_t const capacity = header->capacity;
+        std::uint64_t const mask = capacity - 1;
+        std::uint64_t const free_end = header->read.load(std::memory_order_acquire) + capacity;
+
+        if (!_started) {
+            _start = header->write.load(std::memory_order_relaxed);
+            _size = _pad = 0;
+            _started = true;
+        }
+
+        std::size_t const size = _size + str.size();
+        std::uint64_t begin = _start + _pad;
+        if (sizeof(shm_record_header) + size > capacity) {
+            _overflow = true;
+            return;
+        }
+
+        // a record that would cross the end of the ring moves to its start behind padding
+        if ((begin & mask) + sizeof(shm_record_header) + size > capacity) {
+            std::uint64_t const pad = capacity - (_start & mask);
+            begin = _start + pad;
+            if (begin + sizeof(shm_record_header) + size > free_end) {
+                _overflow = true;
+                return;
+            }
+            std::memmove(_ring.data() + sizeof(shm_record_header), _ring.data() + (_start & mask) + sizeof(shm_record_header), _size);
+            _pad = static_cast<std::size_t>(pad);
+        }
+        else if (begin + sizeof(shm_record_header) + size > free_end) {
+            _overflow = true;
+            return;
+        }
+
+        std::memcpy(_ring.data() + (begin & mask) + sizeof(shm_record_header) + _size, str.data(), str.size());
+        _size = size;
+
+        std::uint64_t const contiguous_end = begin + (capacity - (begin & mask));
+        _limit = contiguous_end < free_end ? contiguous_end : free_end;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring_writer::commit() noexcept {
+        if (!_started) {
+            _reserve(string_view());
+        }
+
+        shm_ring_header* const header = _ring.header();
+        if (_overflow) {
+            if (header != nullptr) {
+                header->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            cancel();
+            return result_code::out_of_space;
+        }
+
+        std::uint64_t const mask = header->capacity - 1;
+        std::uint64_t const begin = _start + _pad;
+        if (_pad != 0) {
+            mark_padding(_ring.data(), _start & mask, _pad);
+        }
+
+        shm_record_header& record = record_at(_ring.data(), begin & mask);
+        record.size = static_cast<std::uint32_t>(_size);
+        record.state.store(shm_record_header::record, std::memory_order_release);
+        header->write.store(begin + footprint(_size), std::memory_order_relaxed);
+
+        cancel();
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC result_code FORMATXX_API shm_ring_producer::publish(string_view text) noexcept {
+        shm_ring_header* const header = _ring.header();
+        if (header == nullptr) {
+            return result_code::io_error;
+        }
+
+        std::uint64_t const capacity = header->capacity;
+        std::uint64_t const mask = capacity - 1;
+        std::uint64_t const size = footprint(text.size());
+        if (size > capacity) {
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return result_code::out_of_space;
+        }
+
+        std::uint64_t position = header->write.load(std::memory_order_relaxed);
+        std::uint64_t pad = 0;
+        do {
+            std::uint64_t const tail = capacity - (position & mask);
+            pad = size > tail ? tail : 0;
+            if (position + pad + size > header->read.load(std::memory_order_acquire) + capacity) {
+                header->dropped.fetch_add(1, std::memory_order_relaxed);
+                return result_code::out_of_space;
+            }
+        } while (!header->write.compare_exchange_weak(position, position + pad + size, std::memory_order_relaxed));
+
+        if (pad != 0) {
+            mark_padding(_ring.data(), position & mask, pad);
+        }
+
+        std::uint64_t const offset = (position + pad) & mask;
+        std::memcpy(_ring.data() + offset + sizeof(shm_record_header), text.data(), text.size());
+
+        shm_record_header& record = record_at(_ring.data(), offset);
+        record.size = static_cast<std::uint32_t>(text.size());
+        record.state.store(shm_record_header::record, std::memory_order_release);
+        return result_code::success;
+    }
+
+    FORMATXX_PUBLIC std::size_t FORMATXX_API shm_ring_reader::_poll(visit_thunk thunk, void* context, std::size_t max_records) noexcept {
+        shm_ring_header* const header = _ring.header();
+        if (header == nullptr) {
+            return 0;
+        }
+
+        std::uint64_t const capacity = header->capacity;
+        std::uint64_t const mask = capacity - 1;
+        std::uint64_t position = header->read.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+
+        while (count != max_records) {
+            std::uint64_t const offset = position & mask;
+            shm_record_header& record = record_at(_ring.data(), offset);
+            std::uint32_t const state = record.state.load(std::memory_order_acquire);
+            if (state == shm_record_header::empty) {
+                break;
+            }
+
+            std::uint64_t const size = footprint(record.size);
+            if (offset + size > capacity) {
+                break; // corrupt; leave the ring untouched
+            }
+
+            if (state == shm_record_header::record) {
+                thunk(context, string_view(_ring.data() + offset + sizeof(shm_record_header), record.size));
+                ++count;
+            }
+
+            // producers rely on free space being zeroed
+            std::memset(_ring.data() + offset + sizeof(shm_record_header), 0, static_cast<std::size_t>(size - sizeof(shm_record_header)));
+            record.size = 0;
+            record.state.store(shm_record_header::empty, std::memory_order_relaxed);
+            position += size;
+        }
+
+        header->read.store(position, std::memory_order_release);
+        return count;
+    }
+} // namespace formatxx
@@ -0,0 +1,238 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+
+#include <formatxx/structured.h>
+
+#include <formatxx/_detail/format_traits.h>
+#include <formatxx/_detail/structured_impl.h>
+
+namespace {
+    void write_field_name(formatxx::format_writer& out, formatxx::string_view name, unsigned index) {
+        if (!name.empty()) {
+            out.write(name);
+        }
+        else {
+            formatxx::format_to(out, "arg{}", index);
+        }
+    }
+
+    /// Write text with the characters special to a quoted string escaped; JSON also escapes other control characters.
+    void write_escaped(formatxx::format_writer& out, formatxx::string_view text, bool json) {
+        char const* begin = text.data();
+        char const* const end = begin + text.size();
+
+        for (char const* iter = begin; iter != end; ++iter) {
+            char const ch = *iter;
+            char const* escape = nullptr;
+            switch (ch) {
+            case '"': escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+            case '\t': escape = "\\t"; break;
+            default:
+                if (!json || static_cast<unsigned char>(ch) >= 0x20) {
+                    continue;
+                }
+                break;
+            }
+
+            if (iter != begin) {
+                out.write({ begin, iter });
+            }
+            if (escape != nullptr) {
+                out.write(escape);
+            }
+            else {
+                formatxx::format_to(out, "\\u{:04x}", static_cast<unsigned>(ch));
+            }
+            begin = iter + 1;
+        }
+
+        if (begin != end) {
+            out.write({ begin, end });
+        }
+    }
+
+    /// Write a bare value without padding, which is not part of the value itself.
+    void write_unpadded(formatxx::format_writer& out, formatxx::string_view text) {
+        char const* begin = text.data();
+        char const* const end = begin + text.size();
+
+        for (char const* iter = begin; iter != end; ++iter) {
+            if (*iter == ' ') {
+                if (iter != begin) {
+                    out.write({ begin, iter });
+                }
+                begin = iter + 1;
+            }
+        }
+
+        if (begin != end) {
+            out.write({ begin, end });
+        }
+    }
+
+    /// True for the rendering of a NaN or infinity, which JSON has no number literal for.
+    bool is_non_finite(formatxx::string_view text) noexcept {
+        char const* const end = text.data() + text.size();
+        for (char const* iter = text.data(); iter != end; ++iter) {
+            if (*iter == 'n' || *iter == 'N' || *iter == 'i' || *iter == 'I') {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+namespace formatxx {
+    FORMATXX_PUBLIC field_kind FORMATXX_API _detail::field_kind_of(format_arg_type type) noexcept {
+        switch (type) {
+        case format_arg_type::signed_char:
+        case format_arg_type::unsigned_char:
+        case format_arg_type::signed_int:
+        case format_arg_type::unsigned_int:
+        case format_arg_type::signed_short_int:
+        case format_arg_type::unsigned_short_int:
+        case format_arg_type::signed_long_int:
+        case format_arg_type::unsigned_long_int:
+        case format_arg_type::signed_long_long_int:
+        case format_arg_type::unsigned_long_long_int:
+            return field_kind::integer;
+        case format_arg_type::single_float:
+        case format_arg_type::double_float:
+            return field_kind::floating;
+        case format_arg_type::boolean:
+            return field_kind::boolean;
+        case format_arg_type::null_pointer:
+            return field_kind::null;
+        default:
+            return field_kind::string;
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API logfmt_sink::begin_record() {
+        _first = true;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API logfmt_sink::begin_field(string_view name, unsigned index, field_kind kind) {
+        if (!_first) {
+            _out.write(" ");
+        }
+        _first = false;
+
+        write_field_name(_out, name, index);
+        _out.write("=");
+
+        _quoted = kind == field_kind::string;
+        if (_quoted) {
+            _out.write("\"");
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API logfmt_sink::value(string_view text) {
+        if (_quoted) {
+            write_escaped(_out, text, false);
+        }
+        else {
+            write_unpadded(_out, text);
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API logfmt_sink::end_field() {
+        if (_quoted) {
+            _out.write("\"");
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API json_sink::begin_record() {
+        _out.write("{");
+        _first = true;
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API json_sink::begin_field(string_view name, unsigned index, field_kind kind) {
+        _out.write(_first ? "\"" : ",\"");
+        _first = false;
+
+        if (!name.empty()) {
+            write_escaped(_out, name, true);
+        }
+        else {
+            write_field_name(_out, name, index);
+        }
+        _out.write("\":");
+
+        _kind = kind;
+        if (kind == field_kind::string) {
+            _out.write("\"");
+        }
+        else if (kind == field_kind::null) {
+            _out.write("null");
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API json_sink::value(string_view text) {
+        switch (_kind) {
+        case field_kind::string:
+            write_escaped(_out, text, true);
+            break;
+        case field_kind::null:
+            break;
+        case field_kind::floating:
+            // NaN and infinity are quoted, as JSON numbers cannot express them
+            if (is_non_finite(text)) {
+                _out.write("\"");
+                write_unpadded(_out, text);
+                _out.write("\"");
+            }
+            else {
+                write_unpadded(_out, text);
+            }
+            break;
+        default:
+            write_unpadded(_out, text);
+            break;
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API json_sink::end_field() {
+        if (_kind == field_kind::string) {
+            _out.write("\"");
+        }
+    }
+
+    FORMATXX_PUBLIC void FORMATXX_API json_sink::end_record() {
+        _out.write("}");
+    }
+
+    template FORMATXX_PUBLIC result_code FORMATXX_API _detail::structured_impl(basic_format_writer<char>& out, basic_field_sink<char>& sink, basic_string_view<char> format, basic_format_arg_list<char> args);
+    template FORMATXX_PUBLIC result_code FORMATXX_API _detail::structured_impl(basic_format_writer<wchar_t>& out, basic_field_sink<wchar_t>& sink, basic_string_view<wchar_t> format, basic_format_arg_list<wchar_t> args);
+}
@@ -0,0 +1,67 @@
+#include "formatxx/allocation_tracking.h"
+
+#if defined(FORMATXX_TRACK_ALLOCATIONS)
+
+#include "formatxx/format.h"
+#include "formatxx/small_string.h"
+#include "formatxx/std_string.h"
+#include "formatxx/writers.h"
+#include <doctest/doctest.h>
+#include <vector>
+
+/// Check that the given statements make no tracked allocations on the calling thread.
+#define FORMATXX_CHECK_NO_ALLOCATIONS(...) \
+    do { \
+        formatxx::allocation_scope const _formatxx_allocation_scope; \
+        __VA_ARGS__; \
+        DOCTEST_CHECK_EQ(0, _formatxx_allocation_scope.stats().count); \
+    } while (false)
+
+DOCTEST_TEST_CASE("allocation_tracking") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("span") {
+        char buffer[64];
+        span_writer writer(buffer);
+
+        FORMATXX_CHECK_NO_ALLOCATIONS(format_to(writer, "{} {:08x} {}", "text", 1234, 5.5));
+    }
+
+    DOCTEST_SUBCASE("small_string") {
+        small_string<char, 8> string;
+        append_writer writer(string);
+
+        FORMATXX_CHECK_NO_ALLOCATIONS(format_to(writer, "{}", 1234));
+
+        string.clear();
+
+        allocation_scope const scope;
+        format_to(writer, "{}", "0123456789abcdef");
+        DOCTEST_CHECK_EQ(1, scope.stats().count);
+        DOCTEST_CHECK_EQ(17, scope.stats().bytes);
+    }
+
+    DOCTEST_SUBCASE("attribution") {
+        reset_allocation_stats();
+
+        std::string string;
+        append_writer writer(string);
+        format_to(writer, "attributed {:100}", 1);
+
+        std::vector<char> vector;
+        container_writer container(vector);
+        format_to(container, "other {:100}", 2);
+
+        allocation_stats const attributed = allocations_for(string_view("attributed {:100}"));
+        DOCTEST_CHECK_LE(1, attributed.count);
+        DOCTEST_CHECK_LE(100, attributed.bytes);
+
+        allocation_stats const other = allocations_for(string_view("other {:100}"));
+        DOCTEST_CHECK_LE(1, other.count);
+
+        DOCTEST_CHECK_EQ(0, allocations_for(string_view("never used")).count);
+        DOCTEST_CHECK_EQ(attributed.count + other.count, allocation_totals().count);
+    }
+}
+
+#endif // defined(FORMATXX_TRACK_ALLOCATIONS)
@@ -0,0 +1,153 @@
+#include "formatxx/async_logger.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // holds the consumer thread in its first write until opened
+    class gated_writer final : public formatxx::format_writer {
+    public:
+        void write(formatxx::string_view str) override {
+            while (!open.load()) {
+                std::this_thread::yield();
+            }
+            text.append(str.data(), str.size());
+        }
+
+        std::atomic<bool> open = false;
+        std::string text;
+    };
+}
+
+DOCTEST_TEST_CASE("async_logger") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("order") {
+        std::string text;
+        append_writer<std::string> sink(text);
+        {
+            async_logger logger(sink);
+            DOCTEST_CHECK_EQ(result_code::success, logger.format("{}-{}", "ab", 12));
+            DOCTEST_CHECK_EQ(result_code::success, logger.printf("%d%s", 3, "x"));
+
+            logger.flush();
+            DOCTEST_CHECK_EQ("ab-12\n3x\n", text);
+
+            std::string const temporary = "copied";
+            logger.format("{}", temporary);
+        }
+        DOCTEST_CHECK_EQ("ab-12\n3x\ncopied\n", text);
+    }
+
+    DOCTEST_SUBCASE("threads") {
+        std::string text;
+        append_writer<std::string> sink(text);
+
+        async_logger_options options;
+        options.queue_size = 64;
+        async_logger logger(sink, options);
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back([&logger, thread] {
+                for (int index = 0; index != 2000; ++index) {
+                    logger.format("thread {} record {}", thread, index);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        logger.flush();
+
+        int next[4] = {};
+        std::size_t lines = 0;
+        for (std::size_t begin = 0; begin != text.size(); ++lines) {
+            std::size_t const end = text.find('\n', begin);
+            std::string const line = text.substr(begin, end - begin);
+
+            int thread = -1;
+            int index = -1;
+            DOCTEST_CHECK_EQ(2, std::sscanf(line.c_str(), "thread %d record %d", &thread, &index));
+            DOCTEST_CHECK_EQ(next[thread]++, index);
+            begin = end + 1;
+        }
+        DOCTEST_CHECK_EQ(8000, lines);
+        DOCTEST_CHECK_EQ(0, logger.dropped());
+    }
+
+    DOCTEST_SUBCASE("overflow") {
+        gated_writer sink;
+
+        async_logger_options options;
+        options.queue_size = 2;
+        options.slot_size = 64;
+        options.overflow = overflow_policy::drop_and_count;
+        options.separator = "|";
+        async_logger logger(sink, options);
+
+        std::size_t accepted = 0;
+        for (int index = 0; index != 10; ++index) {
+            accepted += logger.format("{}", index) == result_code::success;
+        }
+        DOCTEST_CHECK_EQ(10 - accepted, logger.dropped());
+        DOCTEST_CHECK_GT(logger.dropped(), 0);
+
+        sink.open = true;
+        logger.flush();
+        DOCTEST_CHECK_EQ(2 * accepted, sink.text.size());
+
+        // too large for a slot
+        DOCTEST_CHECK_EQ(result_code::out_of_space, logger.format("{}", std::string(100, 'x')));
+        DOCTEST_CHECK_EQ(11 - accepted, logger.dropped());
+    }
+
+    DOCTEST_SUBCASE("shutdown") {
+        std::string text;
+        append_writer<std::string> sink(text);
+
+        async_logger logger(sink);
+        logger.format("{}", 1);
+        logger.shutdown();
+        DOCTEST_CHECK_EQ("1\n", text);
+
+        DOCTEST_CHECK_EQ(result_code::out_of_space, logger.format("{}", 2));
+        DOCTEST_CHECK_EQ(1, logger.dropped());
+        logger.flush();
+        DOCTEST_CHECK_EQ("1\n", text);
+    }
+
+    DOCTEST_SUBCASE("shutdown race") {
+        std::string text;
+        append_writer<std::string> sink(text);
+
+        async_logger_options options;
+        options.queue_size = 16;
+        async_logger logger(sink, options);
+
+        std::atomic<int> accepted = 0;
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back([&logger, &accepted] {
+                for (int index = 0; index != 2000; ++index) {
+                    accepted += logger.format("{}", index) == result_code::success;
+                }
+            });
+        }
+        std::this_thread::yield();
+        logger.shutdown();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // every record is either written or counted as dropped
+        std::size_t const lines = static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+        DOCTEST_CHECK_EQ(static_cast<std::size_t>(accepted.load()), lines);
+        DOCTEST_CHECK_EQ(8000 - lines, logger.dropped());
+    }
+}
@@ -0,0 +1,138 @@
+#include "formatxx/async_writer.h"
+#include "formatxx/format.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <thread>
+
+#if !defined(_WIN32)
+#   include <unistd.h>
+#endif
+
+namespace {
+    int file_descriptor(std::FILE* file) {
+#if defined(_WIN32)
+        return _fileno(file);
+#else
+        return fileno(file);
+#endif
+    }
+
+    std::string read_file(std::FILE* file) {
+        std::string contents;
+        char buffer[256];
+        std::rewind(file);
+        while (std::size_t const count = std::fread(buffer, 1, sizeof(buffer), file)) {
+            contents.append(buffer, count);
+        }
+        return contents;
+    }
+}
+
+DOCTEST_TEST_CASE("async_writer") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("fence") {
+        std::FILE* file = std::tmpfile();
+        DOCTEST_CHECK(file != nullptr);
+
+        {
+            async_writer_options options;
+            options.buffer_size = 16;
+            options.buffer_count = 2;
+
+            async_fd_writer writer;
+            DOCTEST_CHECK_EQ(result_code::success, writer.open(file_descriptor(file), options));
+
+            format_to(writer, "{}-{}", "ab", 12);
+            DOCTEST_CHECK_EQ(result_code::success, writer.fence());
+            DOCTEST_CHECK_EQ("ab-12", read_file(file));
+
+            // spans several buffers
+            format_to(writer, "|{}|", "0123456789abcdef0123456789abcdef");
+            DOCTEST_CHECK_EQ(result_code::success, writer.fence());
+            DOCTEST_CHECK_EQ("ab-12|0123456789abcdef0123456789abcdef|", read_file(file));
+            DOCTEST_CHECK_EQ(0, writer.dropped_bytes());
+        }
+
+        std::fclose(file);
+    }
+
+    DOCTEST_SUBCASE("ordering") {
+        std::FILE* file = std::tmpfile();
+        DOCTEST_CHECK(file != nullptr);
+
+        std::string expected;
+        {
+            async_writer_options options;
+            options.buffer_size = 64;
+            options.buffer_count = 3;
+
+            async_fd_writer writer;
+            DOCTEST_CHECK_EQ(result_code::success, writer.open(file_descriptor(file), options));
+
+            for (int line = 0; line != 1000; ++line) {
+                format_to(writer, "line {:4}\n", line);
+                format_append(expected, "line {:4}\n", line);
+                if (line % 97 == 0) {
+                    writer.flush();
+                }
+            }
+
+            DOCTEST_CHECK_EQ(result_code::success, writer.close());
+        }
+
+        DOCTEST_CHECK_EQ(expected, read_file(file));
+        std::fclose(file);
+    }
+
+#if !defined(_WIN32)
+    DOCTEST_SUBCASE("io_uring pipe") {
+        int pipe_fds[2];
+        DOCTEST_REQUIRE_EQ(0, ::pipe(pipe_fds));
+
+        std::string received;
+        std::thread reader([&] {
+            char buffer[512];
+            ssize_t count;
+            while ((count = ::read(pipe_fds[0], buffer, sizeof(buffer))) > 0) {
+                received.append(buffer, static_cast<std::size_t>(count));
+            }
+        });
+
+        std::string expected;
+        {
+            // buffers larger than a pipe holds, so writes may complete short
+            async_writer_options options;
+            options.buffer_size = 256 * 1024;
+            options.buffer_count = 4;
+
+            async_fd_writer writer;
+            DOCTEST_CHECK_EQ(result_code::success, writer.open(pipe_fds[1], options));
+
+            // skipped when the library is built without liburing or the kernel refuses a ring
+            if (writer.uses_io_uring()) {
+                for (int line = 0; line != 100000; ++line) {
+                    format_to(writer, "line {:6}\n", line);
+                    format_append(expected, "line {:6}\n", line);
+                }
+                DOCTEST_CHECK_EQ(result_code::success, writer.close());
+            }
+        }
+
+        ::close(pipe_fds[1]);
+        reader.join();
+        ::close(pipe_fds[0]);
+
+        DOCTEST_CHECK_EQ(expected, received);
+    }
+#endif
+
+    DOCTEST_SUBCASE("closed") {
+        async_fd_writer writer;
+        format_to(writer, "{}", "dropped");
+        DOCTEST_CHECK_EQ(7, writer.dropped_bytes());
+        DOCTEST_CHECK_EQ(result_code::success, writer.fence());
+        DOCTEST_CHECK_FALSE(writer.uses_io_uring());
+    }
+}
@@ -0,0 +1,161 @@
+#include "formatxx/binlog.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <string>
+
+namespace {
+    struct point {
+        int x = 0;
+        int y = 0;
+    };
+
+    void format_value(formatxx::format_writer& out, point const& value, formatxx::format_options const&) {
+        formatxx::format_to(out, "({}, {})", value.x, value.y);
+    }
+
+    enum class level { info, warn };
+
+    void format_value(formatxx::format_writer& out, level value, formatxx::format_options const&) {
+        out.write(value == level::warn ? "WARN" : "INFO");
+    }
+
+    struct long_text {};
+
+    void format_value(formatxx::format_writer& out, long_text, formatxx::format_options const&) {
+        for (int index = 0; index != 100; ++index) {
+            out.write("abcd");
+        }
+    }
+
+    std::string decode(std::string const& log) {
+        std::string text;
+        formatxx::append_writer<std::string> writer(text);
+        formatxx::binlog_decoder decoder;
+        DOCTEST_CHECK_EQ(formatxx::result_code::success, decoder.decode(formatxx::string_view(log.data(), log.size()), writer));
+        return text;
+    }
+}
+
+DOCTEST_TEST_CASE("binlog") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("roundtrip") {
+        std::string log;
+        append_writer<std::string> sink(log);
+        binlog_writer writer(sink);
+
+        std::string expected;
+        for (int index = 0; index != 3; ++index) {
+            writer.format("{} {:+} {:x} {}", index, -1234567890123LL, 255u, 2.5);
+            format_append(expected, "{} {:+} {:x} {}\n", index, -1234567890123LL, 255u, 2.5);
+        }
+        writer.printf("%s=%5.2f %c", "pi", 3.14159f, 'z');
+        format_append(expected, "{}\n", printf_string("%s=%5.2f %c", "pi", 3.14159f, 'z'));
+        writer.format("{} {} {} {}", std::string("text"), L"wide", true, static_cast<short>(-7));
+        format_append(expected, "{} {} {} {}\n", std::string("text"), L"wide", true, static_cast<short>(-7));
+        writer.format("{:>10}|{}", point{ 1, 2 }, nullptr);
+        format_append(expected, "{:>10}|{}\n", "(1, 2)", nullptr);
+
+        DOCTEST_CHECK_EQ(4, writer.dictionary_size());
+        DOCTEST_CHECK_EQ(expected, decode(log));
+    }
+
+    DOCTEST_SUBCASE("custom") {
+        std::string log;
+        append_writer<std::string> sink(log);
+        binlog_writer writer(sink);
+
+        // overloads win over the enum's value, and long renderings are kept whole
+        writer.format("{} {}", level::warn, long_text{});
+        DOCTEST_CHECK_EQ(format_string("{} {}\n", level::warn, long_text{}), decode(log));
+        DOCTEST_CHECK_EQ(5 + 400 + 1, decode(log).size());
+    }
+
+    DOCTEST_SUBCASE("compact") {
+        std::string log;
+        append_writer<std::string> sink(log);
+        binlog_writer writer(sink);
+
+        writer.format("request {} took {} us", 1u, 250u);
+        std::size_t const first = log.size();
+        writer.format("request {} took {} us", 2u, 300u);
+
+        // entry tag, id, count, then two tagged varints of one and two bytes
+        DOCTEST_CHECK_EQ(8, log.size() - first);
+    }
+
+    DOCTEST_SUBCASE("malformed") {
+        std::string text;
+        append_writer<std::string> writer(text);
+        binlog_decoder decoder;
+
+        DOCTEST_CHECK_EQ(result_code::malformed_input, decoder.decode("not a log", writer));
+
+        std::string log;
+        append_writer<std::string> sink(log);
+        {
+            binlog_writer encoder(sink);
+            encoder.format("{}", 1);
+        }
+        log.pop_back();
+        DOCTEST_CHECK_EQ(result_code::malformed_input, decoder.decode(string_view(log.data(), log.size()), writer));
+    }
+
+    DOCTEST_SUBCASE("reused buffer") {
+        std::string log;
+        append_writer<std::string> sink(log);
+        binlog_writer writer(sink);
+
+        // same address and length, different text
+        char format[] = "a {}";
+        writer.format(string_view(format), 1);
+        format[0] = 'b';
+        writer.format(string_view(format), 2);
+        writer.format(string_view(format), 3);
+
+        DOCTEST_CHECK_EQ(2, writer.dictionary_size());
+        DOCTEST_CHECK_EQ("a 1\nb 2\nb 3\n", decode(log));
+    }
+
+    DOCTEST_SUBCASE("feed") {
+        std::string log;
+        append_writer<std::string> sink(log);
+        {
+            binlog_writer writer(sink);
+            for (int index = 0; index != 20; ++index) {
+                writer.format("{} {} {}", index, "text", 0.5 * index);
+            }
+        }
+
+        std::string const expected = decode(log);
+        for (std::size_t piece : { 1, 3, 7, 64 }) {
+            std::string text;
+            append_writer<std::string> writer(text);
+            binlog_decoder decoder;
+            for (std::size_t offset = 0; offset < log.size(); offset += piece) {
+                DOCTEST_CHECK_EQ(result_code::success, decoder.feed(string_view(log.data() + offset, std::min(piece, log.size() - offset)), writer));
+            }
+            DOCTEST_CHECK_EQ(result_code::success, decoder.finish());
+            DOCTEST_CHECK_EQ(expected, text);
+        }
+
+        // a log cut off part way through an entry
+        std::string text;
+        append_writer<std::string> writer(text);
+        binlog_decoder decoder;
+        DOCTEST_CHECK_EQ(result_code::success, decoder.feed(string_view(log.data(), log.size() - 1), writer));
+        DOCTEST_CHECK_EQ(result_code::malformed_input, decoder.finish());
+        DOCTEST_CHECK_EQ(result_code::malformed_input, decoder.feed("not a log", writer));
+    }
+
+    DOCTEST_SUBCASE("dictionary full") {
+        std::string log;
+        append_writer<std::string> sink(log);
+        binlog_writer writer(sink, 1);
+
+        DOCTEST_CHECK_EQ(result_code::success, writer.format("{}", 1));
+        DOCTEST_CHECK_EQ(result_code::out_of_space, writer.format("{} {}", 1, 2));
+        DOCTEST_CHECK_EQ("1\n", decode(log));
+    }
+}
@@ -0,0 +1,111 @@
+#include "formatxx/catalog.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#if !defined(_WIN32)
+#   include <unistd.h>
+#endif
+
+namespace {
+    char const catalog_text[] =
+        "# greetings\n"
+        "greeting=Hello, {name}!\n"
+        "\n"
+        "disk.full = Disk {0} is {1:3}% full\r\n"
+        "duplicate=first\n"
+        "no separator here\n"
+        "duplicate=second\n"
+        "=no id\n"
+        "broken=open {";
+}
+
+DOCTEST_TEST_CASE("catalog") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("lookup") {
+        format_catalog catalog;
+        DOCTEST_CHECK_EQ(result_code::success, catalog.assign(catalog_text));
+        DOCTEST_CHECK_EQ(5, catalog.size());
+
+        std::string text;
+        append_writer<std::string> writer(text);
+
+        DOCTEST_CHECK_EQ(result_code::success, catalog.format_to(writer, "greeting", "world"));
+        DOCTEST_CHECK_EQ("Hello, world!", text);
+
+        // the second use renders the already compiled template
+        text.clear();
+        DOCTEST_CHECK_EQ(result_code::success, catalog.format_to(writer, "greeting", "again"));
+        DOCTEST_CHECK_EQ("Hello, again!", text);
+
+        text.clear();
+        std::size_t const disk = catalog.find("disk.full");
+        DOCTEST_CHECK_NE(format_catalog::npos, disk);
+        DOCTEST_CHECK_EQ("Disk {0} is {1:3}% full", std::string(catalog.text(disk).data(), catalog.text(disk).size()));
+        DOCTEST_CHECK_EQ(result_code::success, catalog.format_to(writer, disk, "/var", 97));
+        DOCTEST_CHECK_EQ("Disk /var is  97% full", text);
+
+        text.clear();
+        catalog.format_to(writer, "duplicate");
+        DOCTEST_CHECK_EQ("first", text);
+
+        text.clear();
+        DOCTEST_CHECK_EQ(result_code::malformed_input, catalog.format_to(writer, "broken"));
+        DOCTEST_CHECK_EQ("open {", text);
+
+        DOCTEST_CHECK_EQ(format_catalog::npos, catalog.find("missing"));
+        DOCTEST_CHECK_EQ(result_code::out_of_range, catalog.format_to(writer, "missing", 1));
+    }
+
+    DOCTEST_SUBCASE("threads") {
+        format_catalog catalog;
+        catalog.assign(catalog_text);
+
+        std::vector<std::string> results(8);
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 0; thread != results.size(); ++thread) {
+            threads.emplace_back([&catalog, &results, thread] {
+                append_writer<std::string> writer(results[thread]);
+                for (int index = 0; index != 100; ++index) {
+                    results[thread].clear();
+                    catalog.format_to(writer, "disk.full", thread, index);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (std::size_t thread = 0; thread != results.size(); ++thread) {
+            DOCTEST_CHECK_EQ(format_string("Disk {} is  99% full", thread), results[thread]);
+        }
+    }
+
+#if !defined(_WIN32)
+    DOCTEST_SUBCASE("file") {
+        char path[] = "/tmp/formatxx_catalog_XXXXXX";
+        int const fd = ::mkstemp(path);
+        DOCTEST_CHECK_NE(-1, fd);
+        DOCTEST_CHECK_EQ(static_cast<ssize_t>(sizeof(catalog_text) - 1), ::write(fd, catalog_text, sizeof(catalog_text) - 1));
+        ::close(fd);
+
+        format_catalog catalog;
+        DOCTEST_CHECK_EQ(result_code::success, catalog.open(path));
+        DOCTEST_CHECK_EQ(5, catalog.size());
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        catalog.format_to(writer, "greeting", "file");
+        DOCTEST_CHECK_EQ("Hello, file!", text);
+
+        catalog.close();
+        DOCTEST_CHECK_EQ(0, catalog.size());
+        std::remove(path);
+
+        DOCTEST_CHECK_EQ(result_code::io_error, catalog.open(path));
+    }
+#endif
+}
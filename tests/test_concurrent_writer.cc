@@ -0,0 +1,80 @@
+#include "formatxx/concurrent_writer.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+DOCTEST_TEST_CASE("concurrent_writer") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("records") {
+        char buffer[16];
+        concurrent_writer writer(buffer);
+
+        DOCTEST_CHECK_EQ(result_code::success, writer.format("{}-{}|", "ab", 12));
+        DOCTEST_CHECK_EQ(result_code::success, writer.printf("%d%s|", 3, "x"));
+        DOCTEST_CHECK_EQ("ab-12|3x|", writer.view());
+
+        // does not fit whole, so nothing of it is kept
+        DOCTEST_CHECK_EQ(result_code::out_of_space, writer.format("{}", "0123456789"));
+        DOCTEST_CHECK_EQ(1, writer.dropped());
+        DOCTEST_CHECK_EQ(result_code::out_of_space, writer.append("z"));
+        DOCTEST_CHECK_EQ("ab-12|3x|", writer.view());
+        DOCTEST_CHECK(writer.complete());
+
+        writer.clear();
+        DOCTEST_CHECK_EQ(result_code::success, writer.append("z"));
+        DOCTEST_CHECK_EQ("z", writer.view());
+    }
+
+    DOCTEST_SUBCASE("truncate") {
+        std::vector<char> buffer(4096);
+        concurrent_writer writer(buffer.data(), buffer.size());
+
+        std::string const text(concurrent_writer::max_record_size + 100, 'x');
+        DOCTEST_CHECK_EQ(result_code::out_of_space, writer.format("{}", text));
+        DOCTEST_CHECK_EQ(result_code::out_of_space, writer.printf("%s", text.c_str()));
+        DOCTEST_CHECK_EQ(2 * concurrent_writer::max_record_size, writer.view().size());
+        DOCTEST_CHECK_EQ(0, writer.dropped());
+    }
+
+    DOCTEST_SUBCASE("threads") {
+        std::vector<char> buffer(1 << 16);
+        concurrent_writer writer(buffer.data(), buffer.size());
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back([&writer, thread] {
+                for (int index = 0; index != 5000; ++index) {
+                    writer.format("[thread {} record {}]\n", thread, index);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        DOCTEST_CHECK(writer.complete());
+        DOCTEST_CHECK_GT(writer.dropped(), 0);
+
+        // every record is whole and each thread's records stay in order
+        std::string const text(writer.view().data(), writer.view().size());
+        int last[4] = { -1, -1, -1, -1 };
+        std::size_t records = 0;
+        for (std::size_t begin = 0; begin != text.size(); ++records) {
+            std::size_t const end = text.find('\n', begin);
+            DOCTEST_CHECK_NE(std::string::npos, end);
+            std::string const record = text.substr(begin, end - begin);
+
+            int thread = -1;
+            int index = -1;
+            DOCTEST_CHECK_EQ(2, std::sscanf(record.c_str(), "[thread %d record %d]", &thread, &index));
+            DOCTEST_CHECK_EQ(format_string("[thread {} record {}]", thread, index), record);
+            DOCTEST_CHECK_GT(index, last[thread]);
+            last[thread] = index;
+            begin = end + 1;
+        }
+        DOCTEST_CHECK_EQ(20000, records + writer.dropped());
+    }
+}
@@ -0,0 +1,76 @@
+#include "formatxx/csv_writer.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+DOCTEST_TEST_CASE("csv_writer") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("columns") {
+        int const ids[] = { 1, -20, 300 };
+        double const prices[] = { 1.5, 0.25, 100 };
+        std::vector<std::string> const names = { "plain", "with,comma", "say \"hi\"\nbye" };
+        char const* const notes[] = { "x", nullptr, "a long note without anything special in it" };
+
+        format_options price_options;
+        price_options.precision = 2;
+
+        csv_exporter exporter;
+        DOCTEST_CHECK_EQ(result_code::success, exporter.add_column("id", ids, 3));
+        DOCTEST_CHECK_EQ(result_code::success, exporter.add_column("price", prices, 3, price_options));
+        DOCTEST_CHECK_EQ(result_code::success, exporter.add_column("name", names.data(), names.size()));
+        DOCTEST_CHECK_EQ(result_code::success, exporter.add_column("note, text", notes, 3));
+        DOCTEST_CHECK_EQ(result_code::out_of_range, exporter.add_column("short", ids, 2));
+        DOCTEST_CHECK_EQ(4, exporter.columns());
+        DOCTEST_CHECK_EQ(3, exporter.rows());
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        DOCTEST_CHECK_EQ(result_code::success, exporter.write(writer));
+        DOCTEST_CHECK_EQ(
+            "id,price,name,\"note, text\"\n"
+            "1,1.50,plain,x\n"
+            "-20,0.25,\"with,comma\",\n"
+            "300,100.00,\"say \"\"hi\"\"\nbye\",a long note without anything special in it\n", text);
+    }
+
+    DOCTEST_SUBCASE("tsv") {
+        unsigned const counts[] = { 7, 255 };
+        std::string const labels[] = { "a,b", "tab\there" };
+
+        format_options hex;
+        hex.specifier = 'x';
+
+        csv_options options;
+        options.delimiter = '\t';
+        options.line_end = "\r\n";
+        options.header = false;
+
+        csv_exporter exporter(options);
+        exporter.add_column("count", counts, 2, hex);
+        exporter.add_column("label", labels, 2);
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        exporter.write(writer);
+        DOCTEST_CHECK_EQ("7\ta,b\r\nff\t\"tab\there\"\r\n", text);
+    }
+
+    DOCTEST_SUBCASE("blocks") {
+        std::vector<long long> values;
+        std::string expected = "value\n";
+        for (long long value = 0; value != 20000; ++value) {
+            values.push_back(value * 7919);
+            expected += format_string("{}\n", values.back());
+        }
+
+        csv_exporter exporter;
+        exporter.add_column("value", values.data(), values.size());
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        exporter.write(writer);
+        DOCTEST_CHECK_EQ(expected, text);
+    }
+}
@@ -0,0 +1,119 @@
+#include "formatxx/dynamic_args.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+
+namespace {
+    enum class color { red, green };
+
+    struct tagged { int id; };
+
+    void format_value(formatxx::format_writer& out, tagged const& value, formatxx::format_options const&) {
+        formatxx::format_to(out, "#{}", value.id);
+    }
+}
+
+DOCTEST_TEST_CASE("dynamic_args") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("copies") {
+        dynamic_format_arg_store<char> store;
+        {
+            std::string temporary = "temporary";
+            store.push_back(temporary);
+            store.push_back(42);
+            store.push_back(2.5);
+            store.push_back("literal");
+            store.push_back(color::green);
+            store.push_back(true);
+            temporary = "overwritten";
+        }
+        DOCTEST_CHECK_EQ(6, store.size());
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        DOCTEST_CHECK_EQ(result_code::success, vformat_to(writer, string_view("{} {:4} {} {} {} {}"), store));
+        DOCTEST_CHECK_EQ(format_string("temporary   42 {} literal 1 true", 2.5), text);
+
+        text.clear();
+        DOCTEST_CHECK_EQ(result_code::success, vprintf_to(writer, string_view("%s=%d"), store));
+        DOCTEST_CHECK_EQ("temporary=42", text);
+    }
+
+    DOCTEST_SUBCASE("embedded nul") {
+        std::string const value("a\0b", 3);
+
+        dynamic_format_arg_store<char> store;
+        store.push_back(value);
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        vformat_to(writer, string_view("[{}]"), store);
+        DOCTEST_CHECK_EQ(format_string("[{}]", value), text);
+        DOCTEST_CHECK_EQ(5, text.size());
+
+        text.clear();
+        vprintf_to(writer, string_view("[%s]"), store);
+        DOCTEST_CHECK_EQ(std::string("[a\0b]", 5), text);
+    }
+
+    DOCTEST_SUBCASE("grows") {
+        // more arguments and string data than the inline capacity
+        dynamic_format_arg_store<char, 2, 8> store;
+        std::string format;
+        std::string expected;
+        for (int index = 0; index != 40; ++index) {
+            if (index % 2 == 0) {
+                store.push_back(index);
+                expected += std::to_string(index);
+            }
+            else {
+                std::string const text(static_cast<std::size_t>(index), 'a' + index % 26);
+                store.push_back(text);
+                expected += text;
+            }
+            format += "{}|";
+            expected += "|";
+
+            std::string text;
+            append_writer<std::string> writer(text);
+            vformat_to(writer, string_view(format), store);
+            DOCTEST_CHECK_EQ(expected, text);
+        }
+
+        store.clear();
+        DOCTEST_CHECK(store.empty());
+        store.push_back("again");
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        vformat_to(writer, string_view("{}"), store);
+        DOCTEST_CHECK_EQ("again", text);
+    }
+
+    DOCTEST_SUBCASE("references") {
+        tagged const value{ 7 };
+        char const* const null_string = nullptr;
+
+        dynamic_format_arg_store<char> store;
+        store.push_back_ref(value);
+        store.push_back(null_string);
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        vformat_to(writer, string_view("[{}][{}]"), store);
+        DOCTEST_CHECK_EQ("[#7][]", text);
+    }
+
+    DOCTEST_SUBCASE("wide") {
+        dynamic_format_arg_store<wchar_t> store;
+        store.push_back(L"wide");
+        store.push_back(std::wstring(L"string"));
+        store.push_back(3u);
+
+        std::wstring text;
+        append_writer<std::wstring> writer(text);
+        vformat_to(writer, wstring_view(L"{} {} {}"), store);
+        DOCTEST_CHECK(text == L"wide string 3");
+    }
+}
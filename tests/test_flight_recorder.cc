@@ -0,0 +1,96 @@
+#include "formatxx/flight_recorder.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::vector<std::string> records_of(formatxx::flight_recorder const& recorder) {
+        std::vector<std::string> records;
+        recorder.for_each_record([&records](formatxx::string_view record) { records.emplace_back(record.data(), record.size()); });
+        return records;
+    }
+}
+
+DOCTEST_TEST_CASE("flight_recorder") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("order") {
+        flight_recorder recorder(4096);
+        recorder.format("{}-{}", "ab", 12);
+        recorder.printf("%d%s", 3, "x");
+        recorder.record("");
+
+        std::vector<std::string> const records = records_of(recorder);
+        DOCTEST_CHECK_EQ(3, records.size());
+        DOCTEST_CHECK_EQ("ab-12", records[0]);
+        DOCTEST_CHECK_EQ("3x", records[1]);
+        DOCTEST_CHECK_EQ("", records[2]);
+
+        std::string dumped;
+        append_writer<std::string> writer(dumped);
+        recorder.dump(writer);
+        DOCTEST_CHECK_EQ("ab-12\n3x\n\n", dumped);
+    }
+
+    DOCTEST_SUBCASE("overwrite") {
+        flight_recorder recorder(4096);
+        for (int index = 0; index != 1000; ++index) {
+            recorder.format("record {:4} spanning more than a single slot of the ring", index);
+        }
+
+        std::vector<std::string> const records = records_of(recorder);
+        DOCTEST_CHECK_GT(records.size(), 0);
+        DOCTEST_CHECK_LT(records.size(), 1000);
+        DOCTEST_CHECK_EQ(format_string("record {:4} spanning more than a single slot of the ring", 999), records.back());
+
+        // survivors are the newest, contiguous and in order
+        int expected = 1000 - static_cast<int>(records.size());
+        for (std::string const& record : records) {
+            DOCTEST_CHECK_EQ(format_string("record {:4} spanning more than a single slot of the ring", expected++), record);
+        }
+    }
+
+    DOCTEST_SUBCASE("truncate") {
+        flight_recorder recorder(8192);
+        std::string const text(flight_recorder::max_record_size + 100, 'x');
+        recorder.record(text);
+
+        std::vector<std::string> const records = records_of(recorder);
+        DOCTEST_CHECK_EQ(1, records.size());
+        DOCTEST_CHECK_EQ(text.substr(0, flight_recorder::max_record_size), records[0]);
+
+        // formatted records report the truncation but are still kept
+        DOCTEST_CHECK_EQ(result_code::out_of_space, recorder.format("{}", text));
+        DOCTEST_CHECK_EQ(result_code::out_of_space, recorder.printf("%s", text.c_str()));
+        DOCTEST_CHECK_EQ(3, records_of(recorder).size());
+    }
+
+    DOCTEST_SUBCASE("threads") {
+        flight_recorder recorder(1 << 16);
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back([&recorder, thread] {
+                for (int index = 0; index != 2000; ++index) {
+                    recorder.format("thread {} record {}", thread, index);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // every surviving record is intact and each thread's records stay in order
+        int last[4] = { -1, -1, -1, -1 };
+        for (std::string const& record : records_of(recorder)) {
+            int thread = -1;
+            int index = -1;
+            DOCTEST_CHECK_EQ(2, std::sscanf(record.c_str(), "thread %d record %d", &thread, &index));
+            DOCTEST_CHECK_EQ(record, format_string("thread {} record {}", thread, index));
+            DOCTEST_CHECK_GT(index, last[thread]);
+            last[thread] = index;
+        }
+    }
+}
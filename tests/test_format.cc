@@ -170,6 +170,28 @@ DOCTEST_TEST_CASE("format") {
         DOCTEST_CHECK_EQ(formatxx::result_code::out_of_range, format_to(writer, "{0} {1} {5}", "abc", 9, 12.57));
     }
 
+    DOCTEST_SUBCASE("malformed output") {
+        std::string text;
+        append_writer writer(text);
+
+        // an unterminated directive is written once as text, along with what precedes it
+        DOCTEST_CHECK_EQ(formatxx::result_code::malformed_input, format_to(writer, "x{abc", 7));
+        DOCTEST_CHECK_EQ("x{abc", text);
+
+        text.clear();
+        DOCTEST_CHECK_EQ(formatxx::result_code::malformed_input, format_to(writer, "x{0:", 7));
+        DOCTEST_CHECK_EQ("x{0:", text);
+
+        text.clear();
+        DOCTEST_CHECK_EQ(formatxx::result_code::malformed_input, format_to(writer, "{}-{0:4d", 7));
+        DOCTEST_CHECK_EQ("7-{0:4d", text);
+
+        // an invalid directive is dropped up to the bad character, then the text resumes
+        text.clear();
+        DOCTEST_CHECK_EQ(formatxx::result_code::malformed_input, format_to(writer, "x{0!}y", 7));
+        DOCTEST_CHECK_EQ("x!}y", text);
+    }
+
     DOCTEST_SUBCASE("format_value_into") {
         DOCTEST_CHECK_EQ("123", format_as_string(123));
     }
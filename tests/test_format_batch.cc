@@ -0,0 +1,108 @@
+#include "formatxx/format_batch.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+    struct throwing {
+        int value = 0;
+    };
+
+    void format_value(formatxx::format_writer& out, throwing const& arg, formatxx::format_options const&) {
+        if (arg.value == 3000) {
+            throw std::runtime_error("bad record");
+        }
+        formatxx::format_to(out, "{}", arg.value);
+    }
+}
+
+DOCTEST_TEST_CASE("format_batch") {
+    using namespace formatxx;
+
+    std::vector<std::tuple<int, std::string, double>> records;
+    std::string expected;
+    for (int index = 0; index != 5000; ++index) {
+        records.emplace_back(index, std::string(static_cast<std::size_t>(index % 13), 'a' + index % 26), index * 0.5);
+        expected += format_string("{:05}|{}|{}\n", index, std::get<1>(records.back()), std::get<2>(records.back()));
+    }
+
+    DOCTEST_SUBCASE("order") {
+        for (unsigned threads : { 1u, 2u, 7u }) {
+            for (std::size_t chunk_size : { std::size_t(1), std::size_t(37), std::size_t(512), std::size_t(10000) }) {
+                format_batch_options options;
+                options.threads = threads;
+                options.chunk_size = chunk_size;
+
+                std::string text;
+                append_writer<std::string> writer(text);
+                DOCTEST_CHECK_EQ(result_code::success, format_batch(writer, "{:05}|{}|{}\n", records, options));
+                DOCTEST_CHECK_EQ(expected, text);
+            }
+        }
+    }
+
+    DOCTEST_SUBCASE("pairs") {
+        std::pair<char const*, int> const pairs[] = { { "a", 1 }, { "b", 2 }, { "c", 3 } };
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        DOCTEST_CHECK_EQ(result_code::success, format_batch(writer, "{}={};", pairs));
+        DOCTEST_CHECK_EQ("a=1;b=2;c=3;", text);
+    }
+
+    DOCTEST_SUBCASE("errors") {
+        format_batch_options options;
+        options.threads = 4;
+        options.chunk_size = 16;
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        DOCTEST_CHECK_EQ(result_code::out_of_range, format_batch(writer, "{} {3}\n", records, options));
+        DOCTEST_CHECK_EQ(format_string("{} \n", 4999), text.substr(text.size() - 6));
+
+        std::vector<std::tuple<int>> const empty;
+        DOCTEST_CHECK_EQ(result_code::success, format_batch(writer, "{}", empty));
+    }
+
+    DOCTEST_SUBCASE("exception") {
+        std::vector<std::tuple<throwing>> failing;
+        for (int index = 0; index != 5000; ++index) {
+            failing.emplace_back(throwing{ index });
+        }
+
+        // a throwing writer must not leave workers running or blocked
+        struct throwing_writer final : format_writer {
+            void write(string_view) override { throw std::runtime_error("bad record"); }
+        };
+        throwing_writer broken;
+        bool writer_thrown = false;
+        try {
+            format_batch(broken, "{}\n", records, format_batch_options{ 4, 16, 4 });
+        }
+        catch (std::runtime_error const&) {
+            writer_thrown = true;
+        }
+        DOCTEST_CHECK(writer_thrown);
+
+        for (unsigned threads : { 1u, 4u }) {
+            format_batch_options options;
+            options.threads = threads;
+            options.chunk_size = 16;
+
+            std::string text;
+            append_writer<std::string> writer(text);
+            bool thrown = false;
+            try {
+                format_batch(writer, "{}\n", failing, options);
+            }
+            catch (std::runtime_error const& error) {
+                thrown = std::string(error.what()) == "bad record";
+            }
+            DOCTEST_CHECK(thrown);
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#include "formatxx/format_record.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+
+namespace {
+    struct point {
+        int x = 0;
+        int y = 0;
+    };
+
+    void format_value(formatxx::format_writer& out, point const& value, formatxx::format_options const&) {
+        formatxx::format_to(out, "({}, {})", value.x, value.y);
+    }
+
+    enum class color { red = 1, green = 2 };
+
+    enum class level { info, warn };
+
+    void format_value(formatxx::format_writer& out, level value, formatxx::format_options const&) {
+        out.write(value == level::warn ? "WARN" : "INFO");
+    }
+
+    template <typename... Args>
+    std::string render(char const* format, Args const& ... args) {
+        alignas(formatxx::record_alignment) unsigned char buffer[512];
+        std::size_t const size = formatxx::capture_format(buffer, sizeof(buffer), format, args...);
+        DOCTEST_CHECK_NE(0, size);
+        DOCTEST_CHECK_EQ(size, formatxx::record_size(buffer));
+
+        // the record owns copies of everything but the format string
+        unsigned char copy[512];
+        std::memcpy(copy, buffer, size);
+        std::memset(buffer, 0xcd, sizeof(buffer));
+
+        std::string result;
+        formatxx::append_writer<std::string> writer(result);
+        DOCTEST_CHECK_EQ(formatxx::result_code::success, formatxx::format_record(writer, copy));
+        return result;
+    }
+}
+
+template <> struct formatxx::capture_by_copy<point> : std::true_type {};
+template <> struct formatxx::capture_by_copy<level> : std::true_type {};
+
+DOCTEST_TEST_CASE("format_record") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("scalars") {
+        DOCTEST_CHECK_EQ(format_string("{} {} {} {} {} {}", 1, -2LL, 3u, 'x', 1.5, true), render("{} {} {} {} {} {}", 1, -2LL, 3u, 'x', 1.5, true));
+        DOCTEST_CHECK_EQ("0002 ff", render("{:04} {:x}", static_cast<short>(2), static_cast<unsigned char>(255)));
+        DOCTEST_CHECK_EQ("2", render("{}", color::green));
+        DOCTEST_CHECK_EQ(format_string("{}", nullptr), render("{}", nullptr));
+
+        int value = 0;
+        DOCTEST_CHECK_EQ(format_string("{}", &value), render("{}", &value));
+    }
+
+    DOCTEST_SUBCASE("strings") {
+        std::string text = "dynamic";
+        char buffer[] = "mutable";
+        char const* const null_string = nullptr;
+
+        std::string const expected = format_string("{} {} {} {:>5}", text, buffer, "literal", string_view("sv"));
+        std::string const rendered = render("{} {} {} {:>5}", text, buffer, "literal", string_view("sv"));
+        DOCTEST_CHECK_EQ(expected, rendered);
+
+        // a null string is captured as empty
+        DOCTEST_CHECK_EQ("||", render("|{}|", null_string));
+        DOCTEST_CHECK_EQ("abc", render("{}", L"abc"));
+    }
+
+    DOCTEST_SUBCASE("custom") {
+        DOCTEST_CHECK_EQ("at (3, 4)!", render("at {}!", point{ 3, 4 }));
+
+        // an enum's format_value overload is used, as it is when formatting immediately
+        DOCTEST_CHECK_EQ(format_string("{}", level::warn), render("{}", level::warn));
+        DOCTEST_CHECK_EQ("WARN", render("{}", level::warn));
+    }
+
+    DOCTEST_SUBCASE("printf") {
+        alignas(record_alignment) unsigned char buffer[256];
+        DOCTEST_CHECK_NE(0, capture_printf(buffer, sizeof(buffer), "%s=%05.1f", "pi", 3.14159));
+
+        std::string result;
+        append_writer<std::string> writer(result);
+        format_record(writer, buffer);
+        DOCTEST_CHECK_EQ("pi=003.1", result);
+    }
+
+    DOCTEST_SUBCASE("wide") {
+        alignas(record_alignment) unsigned char buffer[256];
+        DOCTEST_CHECK_NE(0, capture_format<wchar_t>(buffer, sizeof(buffer), L"{}:{}", L"key", 7));
+
+        std::wstring result;
+        append_writer<std::wstring> writer(result);
+        DOCTEST_CHECK_EQ(result_code::success, format_record(writer, buffer));
+        DOCTEST_CHECK_EQ(L"key:7", result);
+
+        // a record only renders with its own character type
+        std::string narrow;
+        append_writer<std::string> narrow_writer(narrow);
+        DOCTEST_CHECK_EQ(result_code::malformed_input, format_record(narrow_writer, buffer));
+    }
+
+    DOCTEST_SUBCASE("overflow") {
+        alignas(record_alignment) unsigned char buffer[64];
+        DOCTEST_CHECK_EQ(0, capture_format(buffer, sizeof(buffer), "{}", std::string(100, 'x')));
+        DOCTEST_CHECK_NE(0, capture_format(buffer, sizeof(buffer), "{}", 42));
+    }
+}
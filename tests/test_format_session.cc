@@ -0,0 +1,72 @@
+#include "formatxx/format_session.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+
+namespace {
+    template <typename SessionT, std::size_t Capacity>
+    std::string drain(SessionT& session, char (&buffer)[Capacity], int& chunks) {
+        std::string text;
+        chunks = 0;
+        for (;;) {
+            formatxx::result_code const result = session.resume(buffer);
+            DOCTEST_CHECK(session.size() <= Capacity);
+            text.append(buffer, session.size());
+            ++chunks;
+            if (result != formatxx::result_code::out_of_space) {
+                return text;
+            }
+        }
+    }
+}
+
+DOCTEST_TEST_CASE("format_session") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("streams") {
+        std::string const long_value(50, 'x');
+        std::string const expected = format_string("head {} mid {:>8} {} tail {{}}", long_value, 1234, 3.25);
+
+        // every buffer size yields the same text, including fields split across buffers
+        for (std::size_t capacity = 1; capacity != 16; ++capacity) {
+            auto session = format_session("head {} mid {:>8} {} tail {{}}", long_value, 1234, 3.25);
+
+            std::string text;
+            char buffer[16];
+            result_code result;
+            do {
+                result = session.resume(buffer, capacity);
+                DOCTEST_CHECK(session.size() <= capacity);
+                text.append(buffer, session.size());
+            } while (result == result_code::out_of_space);
+
+            DOCTEST_CHECK_EQ(result_code::success, result);
+            DOCTEST_CHECK(session.done());
+            DOCTEST_CHECK_EQ(expected, text);
+        }
+    }
+
+    DOCTEST_SUBCASE("exact fit") {
+        char buffer[6];
+        auto session = format_session("{}-{}", "ab", 12);
+
+        int chunks = 0;
+        DOCTEST_CHECK_EQ("ab-12", drain(session, buffer, chunks));
+        DOCTEST_CHECK_EQ(1, chunks);
+
+        auto longer = format_session("{}{}", "abcdef", "ghijkl");
+        DOCTEST_CHECK_EQ("abcdefghijkl", drain(longer, buffer, chunks));
+        DOCTEST_CHECK_EQ(2, chunks);
+    }
+
+    DOCTEST_SUBCASE("errors") {
+        char buffer[4];
+        auto session = format_session("{} {5} end", 1);
+
+        int chunks = 0;
+        DOCTEST_CHECK_EQ("1  end", drain(session, buffer, chunks));
+        DOCTEST_CHECK_EQ(result_code::out_of_range, session.result());
+        DOCTEST_CHECK_EQ(result_code::out_of_range, session.resume(buffer));
+        DOCTEST_CHECK_EQ(0, session.size());
+    }
+}
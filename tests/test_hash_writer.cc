@@ -0,0 +1,61 @@
+#include "formatxx/hash_writer.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+
+DOCTEST_TEST_CASE("hash_writer") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("vectors") {
+        hash_writer writer;
+        DOCTEST_CHECK_EQ(0xEF46DB3751D8E999ULL, writer.digest());
+
+        writer.write("a");
+        DOCTEST_CHECK_EQ(0xD24EC4F1A98C6E5BULL, writer.digest());
+
+        writer.reset();
+        writer.write("ab");
+        writer.write("c");
+        DOCTEST_CHECK_EQ(0x44BC2CF5AD770999ULL, writer.digest());
+
+        writer.reset();
+        writer.write("Nobody inspects the spammish repetition");
+        DOCTEST_CHECK_EQ(0xFBCEA83C8A378BF1ULL, writer.digest());
+    }
+
+    DOCTEST_SUBCASE("streaming") {
+        // fragment boundaries never change the digest, across the 32-byte stripe size
+        std::string text;
+        for (int index = 0; index != 200; ++index) {
+            text += static_cast<char>('a' + index % 26);
+
+            hash_writer whole;
+            whole.write(string_view(text.data(), text.size()));
+
+            hash_writer pieces;
+            for (std::size_t begin = 0; begin < text.size(); begin += 7) {
+                pieces.write(string_view(text.data() + begin, text.size() - begin < 7 ? text.size() - begin : 7));
+            }
+
+            DOCTEST_CHECK_EQ(whole.digest(), pieces.digest());
+        }
+    }
+
+    DOCTEST_SUBCASE("format") {
+        std::string const text = format_string("{} failed with {:#x} after {} retries", "open", 0x2a, 3);
+
+        hash_writer expected;
+        expected.write(string_view(text.data(), text.size()));
+
+        DOCTEST_CHECK_EQ(expected.digest(), format_hash("{} failed with {:#x} after {} retries", "open", 0x2a, 3));
+        DOCTEST_CHECK_NE(expected.digest(), format_hash("{} failed with {:#x} after {} retries", "open", 0x2a, 4));
+
+        // tee mode hashes and forwards the same pass
+        std::string forwarded;
+        append_writer<std::string> next(forwarded);
+        hash_writer tee(next);
+        format_to(tee, "{} failed with {:#x} after {} retries", "open", 0x2a, 3);
+        DOCTEST_CHECK_EQ(text, forwarded);
+        DOCTEST_CHECK_EQ(expected.digest(), tee.digest());
+    }
+}
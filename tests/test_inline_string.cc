@@ -0,0 +1,58 @@
+#include "formatxx/format.h"
+#include "formatxx/inline_string.h"
+#include <doctest/doctest.h>
+
+DOCTEST_TEST_CASE("inline_string") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("initialization") {
+        inline_string<char, 16> buffer;
+
+        static_assert(inline_string<char, 16>::capacity() == 16);
+
+        DOCTEST_CHECK(buffer.empty());
+        DOCTEST_CHECK(!buffer.truncated());
+        DOCTEST_CHECK_EQ(0, buffer.size());
+        DOCTEST_CHECK_EQ(0, std::strcmp("", buffer.c_str()));
+    }
+
+    DOCTEST_SUBCASE("append") {
+        inline_string<char, 16> buffer;
+
+        buffer.append("test", 4);
+        buffer.append(" ", 1);
+        buffer.append("string", 6);
+
+        DOCTEST_CHECK(!buffer.empty());
+        DOCTEST_CHECK(!buffer.truncated());
+        DOCTEST_CHECK_EQ(11, buffer.size());
+        DOCTEST_CHECK_EQ(0, std::strcmp("test string", buffer.c_str()));
+    }
+
+    DOCTEST_SUBCASE("truncate") {
+        inline_string<char, 5> buffer;
+
+        buffer.append("abc", 3);
+        buffer.append("def", 3);
+        buffer.append("ghi", 3);
+
+        DOCTEST_CHECK(buffer.truncated());
+        DOCTEST_CHECK_EQ(5, buffer.size());
+        DOCTEST_CHECK_EQ(0, std::strcmp("abcde", buffer.c_str()));
+
+        buffer.clear();
+
+        DOCTEST_CHECK(buffer.empty());
+        DOCTEST_CHECK(!buffer.truncated());
+    }
+
+    DOCTEST_SUBCASE("format_as") {
+        auto const result = format_as<inline_string<char, 8>>("{}-{}", 12, "ab");
+        DOCTEST_CHECK(!result.truncated());
+        DOCTEST_CHECK_EQ(string_view("12-ab"), string_view(result));
+
+        auto const clipped = format_as<inline_string<char, 8>>("{}", 1234567890);
+        DOCTEST_CHECK(clipped.truncated());
+        DOCTEST_CHECK_EQ(string_view("12345678"), string_view(clipped));
+    }
+}
@@ -0,0 +1,67 @@
+#include "formatxx/lazy.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+
+namespace {
+    // callable, but formatted by its own overload rather than invoked
+    struct counter {
+        int operator()() const { return 1; }
+    };
+
+    void format_value(formatxx::format_writer& out, counter const&, formatxx::format_options const&) {
+        out.write("counter");
+    }
+}
+
+DOCTEST_TEST_CASE("lazy") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("format") {
+        std::string const name = "disk";
+        int const used = 93;
+
+        DOCTEST_CHECK_EQ("[disk at 93%]", format_string("[{}]", lazy("{} at {}%", name, used)));
+        DOCTEST_CHECK_EQ(format_string("{} {}", "literal", 1.5f), format_string("{}", lazy("{} {}", "literal", 1.5f)));
+
+        // scalar temporaries are copied rather than referenced
+        auto const sum = lazy("{}+1={}", used, used + 1);
+        DOCTEST_CHECK_EQ("93+1=94", format_string("{}", sum));
+
+        // nested lazy messages
+        DOCTEST_CHECK_EQ("outer(inner(7))", format_string("{}", lazy("outer({})", lazy("inner({})", 7))));
+
+        // the message's own format string governs; field options are ignored
+        DOCTEST_CHECK_EQ("[7]", format_string("[{:>10}]", lazy("{}", 7)));
+    }
+
+    DOCTEST_SUBCASE("callable") {
+        int calls = 0;
+        auto expensive = [&calls] { ++calls; return std::string("computed"); };
+        auto answer = [] { return 42; };
+
+        auto const message = lazy("value={} {:04}", expensive, answer);
+        DOCTEST_CHECK_EQ(0, calls);
+
+        DOCTEST_CHECK_EQ("value=computed 0042", format_string("{}", message));
+        DOCTEST_CHECK_EQ(1, calls);
+
+        std::string text;
+        append_writer<std::string> writer(text);
+        DOCTEST_CHECK_EQ(result_code::success, message.format_to(writer));
+        DOCTEST_CHECK_EQ("value=computed 0042", text);
+        DOCTEST_CHECK_EQ(2, calls);
+
+        DOCTEST_CHECK_EQ("counter", format_string("{}", lazy("{}", counter{})));
+    }
+
+    DOCTEST_SUBCASE("unused") {
+        bool evaluated = false;
+        auto evaluate = [&evaluated] { evaluated = true; return 0; };
+        {
+            auto const message = lazy("{}", evaluate);
+            static_cast<void>(message);
+        }
+        DOCTEST_CHECK_FALSE(evaluated);
+    }
+}
@@ -0,0 +1,103 @@
+#if !defined(_WIN32)
+
+#include "formatxx/format.h"
+#include "formatxx/mapped_writer.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+    std::string read_path(std::string const& path) {
+        std::string contents;
+        if (std::FILE* const file = std::fopen(path.c_str(), "rb")) {
+            char buffer[4096];
+            while (std::size_t const count = std::fread(buffer, 1, sizeof(buffer), file)) {
+                contents.append(buffer, count);
+            }
+            std::fclose(file);
+        }
+        return contents;
+    }
+
+    std::string temp_path() {
+        char path[] = "/tmp/formatxx_mapped_XXXXXX";
+        int const fd = ::mkstemp(path);
+        if (fd != -1) {
+            ::close(fd);
+        }
+        return path;
+    }
+}
+
+DOCTEST_TEST_CASE("mapped_writer") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("extend") {
+        std::string const path = temp_path();
+
+        mapped_writer_options options;
+        options.window_size = 1;
+
+        std::string expected;
+        {
+            mapped_file_writer writer;
+            DOCTEST_CHECK_EQ(result_code::success, writer.open(path.c_str(), options));
+
+            // enough lines to span several page-sized windows
+            for (int line = 0; line != 1000; ++line) {
+                format_to(writer, "line {:5} of the mapped log\n", line);
+                format_append(expected, "line {:5} of the mapped log\n", line);
+            }
+
+            DOCTEST_CHECK_EQ(expected.size(), writer.size());
+            DOCTEST_CHECK_EQ(result_code::success, writer.close());
+        }
+
+        DOCTEST_CHECK_EQ(expected, read_path(path));
+        std::remove(path.c_str());
+    }
+
+    DOCTEST_SUBCASE("roll") {
+        std::string const path = temp_path();
+        long const page = ::sysconf(_SC_PAGESIZE);
+
+        mapped_writer_options options;
+        options.window_size = page;
+        options.max_file_size = 2 * page;
+        options.sync = mapped_sync::async;
+
+        std::string const block(page / 2, 'x');
+        {
+            mapped_file_writer writer;
+            DOCTEST_CHECK_EQ(result_code::success, writer.open(path.c_str(), options));
+
+            // nine half pages: two full files and a half-filled third
+            for (int index = 0; index != 9; ++index) {
+                writer.write(block);
+            }
+
+            DOCTEST_CHECK_EQ(2, writer.file_index());
+            DOCTEST_CHECK_EQ(result_code::success, writer.close());
+        }
+
+        DOCTEST_CHECK_EQ(4 * block.size(), read_path(path).size());
+        DOCTEST_CHECK_EQ(4 * block.size(), read_path(path + ".1").size());
+        DOCTEST_CHECK_EQ(block, read_path(path + ".2"));
+
+        std::remove(path.c_str());
+        std::remove((path + ".1").c_str());
+        std::remove((path + ".2").c_str());
+    }
+
+    DOCTEST_SUBCASE("open failure") {
+        mapped_file_writer writer;
+        DOCTEST_CHECK_EQ(result_code::io_error, writer.open("/nonexistent/formatxx/mapped"));
+        DOCTEST_CHECK_FALSE(writer.is_open());
+        DOCTEST_CHECK_EQ(result_code::io_error, writer.result());
+        DOCTEST_CHECK_EQ(result_code::io_error, writer.close());
+    }
+}
+
+#endif // !defined(_WIN32)
@@ -0,0 +1,182 @@
+#if !defined(_WIN32)
+
+#include "formatxx/shm_ring.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    std::string ring_name() {
+        return formatxx::format_string("/formatxx_test_{}", static_cast<int>(::getpid()));
+    }
+
+    std::vector<std::string> drain(formatxx::shm_ring& ring) {
+        std::vector<std::string> records;
+        formatxx::shm_ring_reader reader(ring);
+        reader.poll([&records](formatxx::string_view record) { records.emplace_back(record.data(), record.size()); });
+        return records;
+    }
+}
+
+DOCTEST_TEST_CASE("shm_ring") {
+    using namespace formatxx;
+
+    std::string const name = ring_name();
+
+    DOCTEST_SUBCASE("writer") {
+        shm_ring ring;
+        DOCTEST_CHECK_EQ(result_code::success, ring.create(name.c_str(), 4096));
+        DOCTEST_CHECK_EQ(4096, ring.capacity());
+
+        shm_ring_writer writer(ring);
+        DOCTEST_CHECK_EQ(result_code::success, writer.format("{}-{}", "ab", 12));
+
+        // a record built from several format calls
+        format_to(writer, "{}", 1);
+        format_to(writer, "{}", 2);
+        DOCTEST_CHECK_EQ(result_code::success, writer.commit());
+
+        std::vector<std::string> const records = drain(ring);
+        DOCTEST_CHECK_EQ(2, records.size());
+        DOCTEST_CHECK_EQ("ab-12", records[0]);
+        DOCTEST_CHECK_EQ("12", records[1]);
+        DOCTEST_CHECK(drain(ring).empty());
+    }
+
+    DOCTEST_SUBCASE("wrap") {
+        shm_ring ring;
+        DOCTEST_CHECK_EQ(result_code::success, ring.create(name.c_str(), 4096));
+
+        shm_ring_writer writer(ring);
+        shm_ring_producer producer(ring);
+        for (int index = 0; index != 500; ++index) {
+            if (index % 2 == 0) {
+                DOCTEST_CHECK_EQ(result_code::success, writer.format("writer record {:3} with {}", index, std::string(index % 37, '.')));
+            }
+            else {
+                DOCTEST_CHECK_EQ(result_code::success, producer.format("producer record {:3} with {}", index, std::string(index % 41, '.')));
+            }
+
+            std::vector<std::string> const records = drain(ring);
+            DOCTEST_CHECK_EQ(1, records.size());
+            if (index % 2 == 0) {
+                DOCTEST_CHECK_EQ(format_string("writer record {:3} with {}", index, std::string(index % 37, '.')), records.front());
+            }
+            else {
+                DOCTEST_CHECK_EQ(format_string("producer record {:3} with {}", index, std::string(index % 41, '.')), records.front());
+            }
+        }
+    }
+
+    DOCTEST_SUBCASE("full") {
+        shm_ring ring;
+        DOCTEST_CHECK_EQ(result_code::success, ring.create(name.c_str(), 4096));
+
+        shm_ring_producer producer(ring);
+        std::string const text(1000, 'x');
+        int published = 0;
+        while (producer.publish(text) == result_code::success) {
+            ++published;
+        }
+        DOCTEST_CHECK_EQ(4, published);
+        DOCTEST_CHECK_EQ(1, ring.dropped());
+
+        shm_ring_writer writer(ring);
+        DOCTEST_CHECK_EQ(result_code::out_of_space, writer.format("{}", text));
+        DOCTEST_CHECK_EQ(2, ring.dropped());
+
+        DOCTEST_CHECK_EQ(4, drain(ring).size());
+        DOCTEST_CHECK_EQ(result_code::success, writer.format("{}", text));
+    }
+
+    DOCTEST_SUBCASE("truncate") {
+        shm_ring ring;
+        DOCTEST_CHECK_EQ(result_code::success, ring.create(name.c_str(), 1 << 16));
+
+        shm_ring_producer producer(ring);
+        std::string const text(shm_ring_producer::max_record_size + 100, 'x');
+        DOCTEST_CHECK_EQ(result_code::out_of_space, producer.format("{}", text));
+        DOCTEST_CHECK_EQ(result_code::out_of_space, producer.printf("%s", text.c_str()));
+
+        std::vector<std::string> const records = drain(ring);
+        DOCTEST_CHECK_EQ(2, records.size());
+        DOCTEST_CHECK_EQ(text.substr(0, shm_ring_producer::max_record_size), records[0]);
+        DOCTEST_CHECK_EQ(0, ring.dropped());
+    }
+
+    DOCTEST_SUBCASE("threads") {
+        shm_ring ring;
+        DOCTEST_CHECK_EQ(result_code::success, ring.create(name.c_str(), 1 << 16));
+
+        constexpr int per_thread = 1000;
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back([&ring, thread] {
+                shm_ring_producer producer(ring);
+                for (int index = 0; index != per_thread;) {
+                    if (producer.format("thread {} record {}", thread, index) == result_code::success) {
+                        ++index;
+                    }
+                }
+            });
+        }
+
+        int next[4] = {};
+        int received = 0;
+        shm_ring_reader reader(ring);
+        while (received != 4 * per_thread) {
+            received += static_cast<int>(reader.poll([&next](string_view record) {
+                int thread = -1;
+                int index = -1;
+                std::string const text(record.data(), record.size());
+                DOCTEST_CHECK_EQ(2, std::sscanf(text.c_str(), "thread %d record %d", &thread, &index));
+                DOCTEST_CHECK_EQ(next[thread]++, index);
+            }));
+        }
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    DOCTEST_SUBCASE("process") {
+        shm_ring ring;
+        DOCTEST_CHECK_EQ(result_code::success, ring.create(name.c_str(), 4096));
+
+        pid_t const child = ::fork();
+        if (child == 0) {
+            shm_ring shared;
+            if (shared.open(name.c_str()) != result_code::success) {
+                ::_exit(1);
+            }
+            shm_ring_writer writer(shared);
+            for (int index = 0; index != 1000;) {
+                if (writer.format("child record {}", index) == result_code::success) {
+                    ++index;
+                }
+            }
+            ::_exit(0);
+        }
+
+        int next = 0;
+        shm_ring_reader reader(ring);
+        while (next != 1000) {
+            reader.poll([&next](string_view record) {
+                DOCTEST_CHECK_EQ(format_string("child record {}", next++), std::string(record.data(), record.size()));
+            });
+        }
+
+        int status = -1;
+        ::waitpid(child, &status, 0);
+        DOCTEST_CHECK(WIFEXITED(status));
+        DOCTEST_CHECK_EQ(0, WEXITSTATUS(status));
+    }
+
+    shm_ring::unlink(name.c_str());
+}
+
+#endif // !defined(_WIN32)
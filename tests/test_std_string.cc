@@ -0,0 +1,91 @@
+#include "formatxx/format.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <ostream>
+
+namespace {
+    struct scratch_nested { int value; };
+
+    void format_value(formatxx::format_writer& writer, scratch_nested const& nested, formatxx::format_options const& options) {
+        auto const inner = formatxx::format_scratch("<{}>", nested.value);
+        format_value_to(writer, inner.view(), options);
+    }
+}
+
+DOCTEST_TEST_CASE("std_string") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("append") {
+        std::string line = "prefix:";
+
+        DOCTEST_CHECK_EQ(result_code::success, format_append(line, " {} {}", "abc", 123));
+        DOCTEST_CHECK_EQ("prefix: abc 123", line);
+
+        DOCTEST_CHECK_EQ(result_code::success, printf_append(line, " %s", "def"));
+        DOCTEST_CHECK_EQ("prefix: abc 123 def", line);
+
+        // output much larger than the initial estimate
+        format_append(line, "{:200}|{:-300}|", 1, 2);
+        DOCTEST_CHECK_EQ(19 + 200 + 1 + 300 + 1, line.size());
+        DOCTEST_CHECK_EQ('|', line.back());
+
+        std::wstring wide = L"w";
+        format_append(wide, L"{}", 42);
+        DOCTEST_CHECK_EQ(L"w42", wide);
+    }
+
+    DOCTEST_SUBCASE("scratch") {
+        auto const result = format_scratch("{} {}", "abc", 123);
+        DOCTEST_CHECK_EQ("abc 123", result.view());
+        DOCTEST_CHECK_EQ(std::string("abc 123"), result.c_str());
+
+        DOCTEST_CHECK_EQ(L"abc 123", format_scratch<wchar_t>(L"{} {}", L"abc", 123).view());
+        DOCTEST_CHECK_EQ("0x1f", printf_scratch("%#x", 31).view());
+    }
+
+    DOCTEST_SUBCASE("scratch reuse") {
+        char const* first = nullptr;
+        {
+            auto const result = format_scratch("{:64}", "a");
+            first = result.data();
+        }
+        {
+            auto const result = format_scratch("{:64}", "b");
+            DOCTEST_CHECK_EQ(first, result.data());
+        }
+    }
+
+    DOCTEST_SUBCASE("scratch nested") {
+        auto const outer = format_scratch("[{}] [{}]", scratch_nested{1}, scratch_nested{2});
+        DOCTEST_CHECK_EQ("[<1>] [<2>]", outer.view());
+    }
+
+    DOCTEST_SUBCASE("scratch exhausted") {
+        auto const a = format_scratch("{}", 1);
+        auto const b = format_scratch("{}", 2);
+        auto const c = format_scratch("{}", 3);
+        auto const d = format_scratch("{}", 4);
+        auto const e = format_scratch("{}", 5);
+        DOCTEST_CHECK_EQ("12345", format_string("{}{}{}{}{}", a.view(), b.view(), c.view(), d.view(), e.view()));
+    }
+
+    DOCTEST_SUBCASE("scratch take") {
+        std::string taken = format_scratch("{}", "moved").take();
+        DOCTEST_CHECK_EQ("moved", taken);
+    }
+
+    DOCTEST_SUBCASE("scratch limit") {
+        set_scratch_capacity_limit(16);
+        {
+            auto const result = format_scratch("{:128}", "large");
+            DOCTEST_CHECK_EQ(128, result.size());
+        }
+        {
+            auto result = format_scratch("{}", "small");
+            DOCTEST_CHECK_EQ("small", result.view());
+            DOCTEST_CHECK_GE(128, result.take().capacity());
+        }
+        set_scratch_capacity_limit(4096);
+        release_scratch_buffers();
+    }
+}
@@ -0,0 +1,78 @@
+#include "formatxx/structured.h"
+#include "formatxx/std_string.h"
+#include <doctest/doctest.h>
+#include <cmath>
+#include <string>
+
+namespace {
+    struct point { int x; int y; };
+
+    void format_value(formatxx::format_writer& out, point const& value, formatxx::format_options const&) {
+        formatxx::format_to(out, "({}, {})", value.x, value.y);
+    }
+
+    /// Records how often the sink sees each callback.
+    class counting_sink final : public formatxx::field_sink {
+    public:
+        void begin_field(formatxx::string_view name, unsigned index, formatxx::field_kind kind) override {
+            text += formatxx::format_string("[{}#{}:{}=", std::string(name.data(), name.size()), index, static_cast<int>(kind));
+        }
+        void value(formatxx::string_view piece) override { text.append(piece.data(), piece.size()); }
+        void end_field() override { text += "]"; }
+
+        std::string text;
+    };
+}
+
+DOCTEST_TEST_CASE("structured") {
+    using namespace formatxx;
+
+    DOCTEST_SUBCASE("named placeholders") {
+        DOCTEST_CHECK_EQ("bob has    3 items", format_string("{user} has {count:4} items", "bob", 3));
+        DOCTEST_CHECK_EQ("1 2 1", format_string("{a} {b} {0}", 1, 2));
+        DOCTEST_CHECK_EQ("x", format_string("{first_name.v2}", "x"));
+    }
+
+    DOCTEST_SUBCASE("sink") {
+        std::string message;
+        append_writer<std::string> writer(message);
+        counting_sink sink;
+
+        DOCTEST_CHECK_EQ(result_code::success, format_structured(writer, sink, "{user} at {} is {ok}", "ann", point{ 1, 2 }, true));
+        DOCTEST_CHECK_EQ("ann at (1, 2) is true", message);
+        DOCTEST_CHECK_EQ("[user#0:0=ann][#1:0=(1, 2)][ok#2:3=true]", sink.text);
+    }
+
+    DOCTEST_SUBCASE("logfmt") {
+        std::string message;
+        std::string fields;
+        append_writer<std::string> message_writer(message);
+        append_writer<std::string> field_writer(fields);
+        logfmt_sink sink(field_writer);
+
+        DOCTEST_CHECK_EQ(result_code::success, format_structured(message_writer, sink, "user {name} read {bytes:6} bytes in {secs:.2f}s ({})", "said \"hi\"", 512, 0.125, nullptr));
+        DOCTEST_CHECK_EQ("user said \"hi\" read    512 bytes in 0.12s (nullptr)", message);
+        DOCTEST_CHECK_EQ("name=\"said \\\"hi\\\"\" bytes=512 secs=0.12 arg3=nullptr", fields);
+    }
+
+    DOCTEST_SUBCASE("json") {
+        std::string message;
+        std::string fields;
+        append_writer<std::string> message_writer(message);
+        append_writer<std::string> field_writer(fields);
+        json_sink sink(field_writer);
+
+        DOCTEST_CHECK_EQ(result_code::out_of_range, format_structured(message_writer, sink, "{path} {code:x} {n:03} {ok} {none} {9}", "a\tb\x01", 255, 7, false, nullptr));
+        DOCTEST_CHECK_EQ("a\tb\x01 ff 007 false nullptr ", message);
+        DOCTEST_CHECK_EQ("{\"path\":\"a\\tb\\u0001\",\"code\":\"ff\",\"n\":\"007\",\"ok\":false,\"none\":null}", fields);
+
+        fields.clear();
+        format_structured(message_writer, sink, "no fields");
+        DOCTEST_CHECK_EQ("{}", fields);
+
+        // JSON has no literal for these, so they are sent as strings
+        fields.clear();
+        DOCTEST_CHECK_EQ(result_code::success, format_structured(message_writer, sink, "{x} {y} {z:8} {w:E}", NAN, INFINITY, -INFINITY, 1.5e10));
+        DOCTEST_CHECK_EQ("{\"x\":\"nan\",\"y\":\"inf\",\"z\":\"-inf\",\"w\":1.500000E+10}", fields);
+    }
+}
@@ -2,9 +2,35 @@
 #include "formatxx/std_string.h"
 #include "formatxx/small_string.h"
 #include "formatxx/writers.h"
+#include "formatxx/chunked_writer.h"
 #include <doctest/doctest.h>
+#include <cstdio>
 #include <vector>
 #include <ostream>
+#include <thread>
+#if !defined(_WIN32)
+#   include <unistd.h>
+#endif
+
+namespace {
+    int file_descriptor(std::FILE* file) {
+#if defined(_WIN32)
+        return _fileno(file);
+#else
+        return fileno(file);
+#endif
+    }
+
+    std::string read_file(std::FILE* file) {
+        std::string contents;
+        char buffer[256];
+        std::rewind(file);
+        while (std::size_t const count = std::fread(buffer, 1, sizeof(buffer), file)) {
+            contents.append(buffer, count);
+        }
+        return contents;
+    }
+}
 
 DOCTEST_TEST_CASE("writer") {
     using namespace formatxx;
@@ -44,6 +70,197 @@ DOCTEST_TEST_CASE("writer") {
         DOCTEST_CHECK_EQ(string_view("123"), string_view(tmp.data(), tmp.size()));
     }
 
+    DOCTEST_SUBCASE("tee") {
+        std::string first;
+        std::string second;
+        std::string third;
+        append_writer<std::string> first_writer(first);
+        append_writer<std::string> second_writer(second);
+        append_writer<std::string> third_writer(third);
+
+        tee_writer<char, 3> tee(first_writer, second_writer);
+        format_to(tee, "{}-{}", "ab", 12);
+        DOCTEST_CHECK_EQ("ab-12", first);
+        DOCTEST_CHECK_EQ("ab-12", second);
+
+        DOCTEST_CHECK(tee.add(third_writer, 0b10));
+        DOCTEST_CHECK_FALSE(tee.add(third_writer));
+        tee.set_channels(0, 0b01);
+
+        tee.select(0b10);
+        format_to(tee, "|{}", 3);
+        tee.select(0b01);
+        format_to(tee, "|{}", 4);
+
+        DOCTEST_CHECK_EQ("ab-12|4", first);
+        DOCTEST_CHECK_EQ("ab-12|3|4", second);
+        DOCTEST_CHECK_EQ("|3", third);
+    }
+
+    DOCTEST_SUBCASE("chunked") {
+        chunked_writer<char, 4> writer;
+
+        format_to(writer, "{}-{}", "abcdef", 1234567);
+        DOCTEST_CHECK_EQ(14, writer.size());
+
+        std::vector<std::string> pieces;
+        for (string_view chunk : writer.chunks()) {
+            pieces.emplace_back(chunk.data(), chunk.size());
+        }
+        DOCTEST_CHECK_EQ(4, pieces.size());
+        DOCTEST_CHECK_EQ("abcd", pieces.front());
+        DOCTEST_CHECK_EQ("67", pieces.back());
+
+        DOCTEST_CHECK_EQ("abcdef-1234567", writer.flatten<std::string>());
+
+        writer.clear();
+        DOCTEST_CHECK(writer.empty());
+        DOCTEST_CHECK(writer.chunks().begin() == writer.chunks().end());
+    }
+
+    DOCTEST_SUBCASE("fd") {
+        std::FILE* file = std::tmpfile();
+        DOCTEST_CHECK(file != nullptr);
+
+        char buffer[8];
+        {
+            fd_writer writer(file_descriptor(file), buffer);
+
+            format_to(writer, "{}-{}", "ab", 12);
+            DOCTEST_CHECK_EQ("", read_file(file));
+
+            // larger than the buffer, written straight through
+            format_to(writer, "|{}|", "0123456789abcdef");
+            DOCTEST_CHECK_EQ("ab-12|0123456789abcdef", read_file(file));
+
+            DOCTEST_CHECK_EQ(result_code::success, writer.flush());
+            DOCTEST_CHECK_EQ("ab-12|0123456789abcdef|", read_file(file));
+        }
+
+        std::fclose(file);
+    }
+
+    DOCTEST_SUBCASE("fd newline") {
+        std::FILE* file = std::tmpfile();
+        DOCTEST_CHECK(file != nullptr);
+
+        char buffer[64];
+        {
+            fd_writer writer(file_descriptor(file), buffer, fd_flush::newline);
+
+            format_to(writer, "one {}\ntwo", 1);
+            DOCTEST_CHECK_EQ("one 1\n", read_file(file));
+
+            format_to(writer, " {}\n", 2);
+            DOCTEST_CHECK_EQ("one 1\ntwo 2\n", read_file(file));
+
+            writer.write("three");
+        }
+        DOCTEST_CHECK_EQ("one 1\ntwo 2\nthree", read_file(file));
+
+        std::fclose(file);
+    }
+
+    DOCTEST_SUBCASE("fd error") {
+        char buffer[8];
+        fd_writer writer(-1, buffer);
+
+        format_to(writer, "{}", 1234567890);
+        DOCTEST_CHECK_EQ(result_code::io_error, writer.flush());
+        DOCTEST_CHECK_EQ(result_code::io_error, writer.result());
+    }
+
+#if !defined(_WIN32)
+    DOCTEST_SUBCASE("stdout") {
+        std::FILE* file = std::tmpfile();
+        DOCTEST_CHECK(file != nullptr);
+
+        std::fflush(stdout);
+        int const saved = ::dup(1);
+        ::dup2(file_descriptor(file), 1);
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back([thread] {
+                for (int index = 0; index != 100; ++index) {
+                    format_to(stdout_writer(), "thread {} ", thread);
+                    format_to(stdout_writer(), "line {}\n", index);
+                }
+
+                // flushed at thread exit
+                format_to(stdout_writer(), "[thread {} done]", thread);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        ::dup2(saved, 1);
+        ::close(saved);
+
+        // lines from different threads never interleave
+        std::string const text = read_file(file);
+        std::size_t lines = 0;
+        std::size_t done = 0;
+        for (std::size_t begin = 0; begin < text.size();) {
+            std::size_t const end = text.find('\n', begin);
+            std::string line = text.substr(begin, end == std::string::npos ? end : end - begin);
+            begin = end == std::string::npos ? text.size() : end + 1;
+
+            // unterminated fragments flushed at thread exit run into whatever follows them
+            while (!line.empty() && line[0] == '[') {
+                line.erase(0, line.find(']') + 1);
+                ++done;
+            }
+            if (line.empty()) {
+                continue;
+            }
+
+            int thread = -1;
+            int index = -1;
+            DOCTEST_CHECK_EQ(2, std::sscanf(line.c_str(), "thread %d line %d", &thread, &index));
+            DOCTEST_CHECK_EQ(format_string("thread {} line {}", thread, index), line);
+            ++lines;
+        }
+        DOCTEST_CHECK_EQ(4, done);
+        DOCTEST_CHECK_EQ(400, lines);
+
+        std::fclose(file);
+    }
+#endif
+
+    DOCTEST_SUBCASE("iovec") {
+        std::FILE* file = std::tmpfile();
+        DOCTEST_CHECK(file != nullptr);
+
+        char const format[] = "literal text long enough to borrow {} and {:4} then {}\n";
+        std::string const large(40, 'x');
+
+        char buffer[32];
+        {
+            iovec_writer writer(file_descriptor(file), buffer);
+            writer.set_borrow_threshold(16);
+
+            DOCTEST_CHECK_EQ(result_code::success, writer.format(format, large, 7, "short"));
+
+            // borrowed literal, borrowed argument, then copied pieces merged into one span
+            DOCTEST_CHECK_EQ(3, writer.span_count());
+            DOCTEST_CHECK_EQ(static_cast<void const*>(format), writer.spans()[0].data);
+            DOCTEST_CHECK_EQ(static_cast<void const*>(large.data()), writer.spans()[1].data);
+            DOCTEST_CHECK_EQ(static_cast<void const*>(buffer), writer.spans()[2].data);
+            DOCTEST_CHECK_EQ(21, writer.spans()[2].size);
+
+            // plain format_to never borrows
+            format_to(writer, "{}", large);
+            DOCTEST_CHECK_EQ(result_code::success, writer.flush());
+            DOCTEST_CHECK_EQ(0, writer.span_count());
+        }
+
+        DOCTEST_CHECK_EQ("literal text long enough to borrow " + large + " and    7 then short\n" + large, read_file(file));
+
+        std::fclose(file);
+    }
+
     DOCTEST_SUBCASE("append") {
         std::string tmp;
         append_writer writer(tmp);
@@ -0,0 +1,86 @@
+// formatxx - C++ string formatting library.
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non - commercial, and by any
+// means.
+// 
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+// 
+// For more information, please refer to <http://unlicense.org/>
+//
+// Authors:
+//   Sean Middleditch <sean@middleditch.us>
+
+// formatxx-decode: print the text of binary logs written by formatxx::binlog_writer.
+//
+// usage: formatxx-decode [file...]
+// Reads standard input when no files are given.
+
+#include <formatxx/binlog.h>
+#include <formatxx/writers.h>
+#include <cstdio>
+
+namespace {
+    // decodes as the file is read, so logs of any size need only one buffer
+    int decode(char const* name, std::FILE* file) {
+        formatxx::binlog_decoder decoder;
+        formatxx::result_code result = formatxx::result_code::success;
+
+        char buffer[64 * 1024];
+        while (std::size_t const count = std::fread(buffer, 1, sizeof(buffer), file)) {
+            result = decoder.feed(formatxx::string_view(buffer, count), formatxx::stdout_writer());
+            if (result != formatxx::result_code::success) {
+                break;
+            }
+        }
+
+        if (std::ferror(file) != 0) {
+            formatxx::stdout_writer().flush();
+            formatxx::format_to(formatxx::stderr_writer(), "formatxx-decode: cannot read {}\n", name);
+            return 1;
+        }
+        if (result != formatxx::result_code::success || decoder.finish() != formatxx::result_code::success) {
+            formatxx::stdout_writer().flush();
+            formatxx::format_to(formatxx::stderr_writer(), "formatxx-decode: {} is not a valid binary log\n", name);
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return decode("<stdin>", stdin);
+    }
+
+    int status = 0;
+    for (int index = 1; index < argc; ++index) {
+        std::FILE* const file = std::fopen(argv[index], "rb");
+        if (file == nullptr) {
+            formatxx::format_to(formatxx::stderr_writer(), "formatxx-decode: cannot open {}\n", argv[index]);
+            status = 1;
+            continue;
+        }
+
+        status |= decode(argv[index], file);
+        std::fclose(file);
+    }
+    return status;
+}